@@ -0,0 +1,54 @@
+#include "cpu_features.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace small_tl
+{
+  static cpu_features detect_cpu_features()
+  {
+    cpu_features features = {};
+#if defined(SMALL_TL_X86)
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    features.sse2 = (info[3] & (1 << 26)) != 0;
+    features.ssse3 = (info[2] & (1 << 9)) != 0;
+    //avx2 also needs the os to save the ymm registers
+    bool os_saves_ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    if (max_leaf >= 7 && os_saves_ymm)
+    {
+      __cpuidex(info, 7, 0);
+      features.avx2 = (info[1] & (1 << 5)) != 0 && (info[1] & (1 << 3)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    features.sse2 = __builtin_cpu_supports("sse2");
+    features.ssse3 = __builtin_cpu_supports("ssse3");
+    features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi");
+#endif
+#endif
+    return features;
+  }
+
+  static cpu_features limit_cpu_features(cpu_features features)
+  {
+    const char *limit = std::getenv("SMALL_TL_CPU_LIMIT");
+    if (limit == nullptr)
+      return features;
+    if (strcmp(limit, "scalar") == 0)
+      features = {};
+    else if (strcmp(limit, "sse2") == 0)
+      features.ssse3 = features.avx2 = false;
+    else if (strcmp(limit, "ssse3") == 0)
+      features.avx2 = false;
+    return features;
+  }
+
+  const cpu_features &get_cpu_features()
+  {
+    static const cpu_features features = limit_cpu_features(detect_cpu_features());
+    return features;
+  }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SMALL_TL_X86 1
+#endif
+
+//gcc and clang only emit instructions beyond the baseline inside functions that opt in, msvc emits any intrinsic
+#if defined(__GNUC__)
+#define SMALL_TL_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define SMALL_TL_TARGET_AVX2 __attribute__((target("avx2,bmi,popcnt")))
+#else
+#define SMALL_TL_TARGET_SSSE3
+#define SMALL_TL_TARGET_AVX2
+#endif
+
+namespace small_tl
+{
+  //instruction sets available on the running cpu, used to pick kernels at runtime
+  struct cpu_features
+  {
+    bool sse2;
+    bool ssse3;
+    bool avx2;
+  };
+
+  //detected once, SMALL_TL_CPU_LIMIT set to scalar, sse2, ssse3 or avx2 in the environment caps it so every kernel tier can be run on one machine
+  const cpu_features &get_cpu_features();
+
+  //index of the lowest set bit, mask must not be zero
+  inline uint32_t count_trailing_zeros(uint32_t mask)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+  }
+
+  inline uint32_t count_trailing_zeros64(uint64_t mask)
+  {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#elif defined(_MSC_VER)
+    return (uint32_t)mask != 0 ? count_trailing_zeros((uint32_t)mask) : 32 + count_trailing_zeros((uint32_t)(mask >> 32));
+#else
+    return __builtin_ctzll(mask);
+#endif
+  }
+
+  //number of set bits, a popcnt instruction inside functions that target it
+  inline uint32_t count_set_bits64(uint64_t mask)
+  {
+#if defined(_MSC_VER)
+    mask -= (mask >> 1) & 0x5555555555555555ull;
+    mask = (mask & 0x3333333333333333ull) + ((mask >> 2) & 0x3333333333333333ull);
+    mask = (mask + (mask >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (uint32_t)((mask * 0x0101010101010101ull) >> 56);
+#else
+    return __builtin_popcountll(mask);
+#endif
+  }
+
+  //index of the highest set bit, mask must not be zero
+  inline uint32_t highest_set_bit64(uint64_t mask)
+  {
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, mask);
+    return index;
+#elif defined(_MSC_VER)
+    unsigned long index;
+    if (mask >> 32)
+    {
+      _BitScanReverse(&index, (unsigned long)(mask >> 32));
+      return 32 + index;
+    }
+    _BitScanReverse(&index, (unsigned long)mask);
+    return index;
+#else
+    return 63 - __builtin_clzll(mask);
+#endif
+  }
+
+  //a read hint, the address need not be valid
+  inline void prefetch(const void *address)
+  {
+#if defined(_MSC_VER) && defined(SMALL_TL_X86)
+    _mm_prefetch((const char *)address, _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+  }
+}
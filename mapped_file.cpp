@@ -0,0 +1,134 @@
+#include "mapped_file.h"
+#include <utility>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace small_tl
+{
+  mapped_file::mapped_file() noexcept : m_fd(-1), m_mode(read_only), m_data(nullptr), m_size(0) {}
+
+  mapped_file::mapped_file(mapped_file &&other) noexcept : m_fd(other.m_fd), m_mode(other.m_mode), m_data(other.m_data), m_size(other.m_size)
+  {
+    other.m_fd = -1;
+    other.m_data = nullptr;
+    other.m_size = 0;
+  }
+
+  mapped_file &mapped_file::operator=(mapped_file &&other) noexcept
+  {
+    if (this != &other)
+    {
+      close();
+      std::swap(m_fd, other.m_fd);
+      std::swap(m_mode, other.m_mode);
+      std::swap(m_data, other.m_data);
+      std::swap(m_size, other.m_size);
+    }
+    return *this;
+  }
+
+  mapped_file::~mapped_file()
+  {
+    close();
+  }
+
+  static void *map(int fd, size_t bytes, bool writable)
+  {
+    //an empty file can not be mapped, it stays unmapped until it grows
+    if (bytes == 0)
+      return nullptr;
+    void *data = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    return data == MAP_FAILED ? nullptr : data;
+  }
+
+  bool mapped_file::open(const std::string &path, open_mode mode) noexcept
+  {
+    close();
+    int flags = mode == read_only ? O_RDONLY : mode == read_write ? O_RDWR : O_RDWR | O_CREAT | O_TRUNC;
+    int fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd < 0)
+      return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    size_t size = (size_t)file_stat.st_size;
+    void *data = map(fd, size, mode != read_only);
+    if (size != 0 && data == nullptr)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    m_fd = fd;
+    m_mode = mode;
+    m_data = data;
+    m_size = size;
+    return true;
+  }
+
+  void mapped_file::close() noexcept
+  {
+    if (m_data != nullptr)
+      munmap(m_data, m_size);
+    if (m_fd >= 0)
+      ::close(m_fd);
+    m_fd = -1;
+    m_data = nullptr;
+    m_size = 0;
+  }
+
+  bool mapped_file::resize(size_t bytes) noexcept
+  {
+    if (!is_open() || !is_writable())
+      return false;
+    if (bytes == m_size)
+      return true;
+    if (ftruncate(m_fd, (off_t)bytes) != 0)
+      return false;
+
+#if defined(__linux__)
+    if (m_data != nullptr && bytes != 0)
+    {
+      void *data = mremap(m_data, m_size, bytes, MREMAP_MAYMOVE);
+      if (data == MAP_FAILED)
+      {
+        //the old mapping survives a failed mremap, so put the file length back to match it
+        int restored = ftruncate(m_fd, (off_t)m_size);
+        (void)restored;
+        return false;
+      }
+      m_data = data;
+      m_size = bytes;
+      return true;
+    }
+#endif
+
+    if (m_data != nullptr)
+      munmap(m_data, m_size);
+    m_data = map(m_fd, bytes, true);
+    m_size = bytes;
+    if (bytes != 0 && m_data == nullptr)
+    {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  bool mapped_file::sync() noexcept
+  {
+    if (m_data == nullptr)
+      return true;
+    return msync(m_data, m_size, MS_SYNC) == 0;
+  }
+}
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+//posix only, mapped_file.cpp is empty on windows
+#if !defined(_WIN32)
+namespace small_tl
+{
+  //a whole file mapped into memory, writable mappings are shared so changes land in the file and other processes see them
+  //posix only, growth uses ftruncate followed by mremap on linux or a fresh mapping elsewhere
+  class mapped_file
+  {
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &operator=(const mapped_file &) = delete;
+
+  public:
+    enum open_mode
+    {
+      read_only,  //maps an existing file, it can not be written or resized
+      read_write, //maps an existing file
+      create      //creates or truncates the file
+    };
+
+    mapped_file() noexcept;
+    mapped_file(mapped_file &&other) noexcept;
+    mapped_file &operator=(mapped_file &&other) noexcept;
+    ~mapped_file();
+
+    bool open(const std::string &path, open_mode mode) noexcept;
+    void close() noexcept;
+
+    bool is_open() const noexcept { return m_fd >= 0; }
+    bool is_writable() const noexcept { return m_mode != read_only; }
+
+    //sets the file length and remaps it, the contents of the common prefix are kept
+    bool resize(size_t bytes) noexcept;
+
+    //flushes dirty pages to the file
+    bool sync() noexcept;
+
+    void *data() noexcept { return m_data; }
+    const void *data() const noexcept { return m_data; }
+    size_t size() const noexcept { return m_size; }
+
+  private:
+    int m_fd;
+    open_mode m_mode;
+    void *m_data;
+    size_t m_size;
+  };
+}
+#endif
@@ -0,0 +1,213 @@
+#pragma once
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include "mapped_file.h"
+#include "pod_simd.h"
+
+#if !defined(_WIN32)
+namespace small_tl
+{
+  //a pod_vector whose elements live in a memory mapped file, the file is the raw element array with no header
+  //while open for writing the file is kept at capacity, close trims it back to size
+  //a read_only mapping can not be written, so the members that would write to it fail as if growth had failed
+  template<class pod_t>
+  class mmap_pod_vector
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "mmap_pod_vector requires a trivial type");
+  public:
+
+    typedef pod_t value_type;
+    typedef pod_t* iterator;
+    typedef const pod_t* const_iterator;
+
+    mmap_pod_vector() noexcept : m_size(0) {}
+    mmap_pod_vector(mmap_pod_vector &&other) noexcept : m_file(std::move(other.m_file)), m_size(other.m_size) { other.m_size = 0; }
+    mmap_pod_vector &operator=(mmap_pod_vector &&other) noexcept
+    {
+      if (this != &other)
+      {
+        close();
+        m_file = std::move(other.m_file);
+        m_size = other.m_size;
+        other.m_size = 0;
+      }
+      return *this;
+    }
+    ~mmap_pod_vector() { close(); }
+
+    //read_only serves the file's elements in place, create starts an empty file
+    bool open(const std::string &path, mapped_file::open_mode mode) noexcept
+    {
+      close();
+      if (!m_file.open(path, mode))
+        return false;
+      m_size = m_file.size() / sizeof(pod_t);
+      return true;
+    }
+
+    //trims the file to the elements in use and unmaps it
+    void close() noexcept
+    {
+      if (m_file.is_open() && m_file.is_writable())
+        m_file.resize(m_size * sizeof(pod_t));
+      m_file.close();
+      m_size = 0;
+    }
+
+    bool is_open() const noexcept { return m_file.is_open(); }
+    bool is_writable() const noexcept { return m_file.is_writable(); }
+    bool sync() noexcept { return m_file.sync(); }
+
+    pod_t& at(size_t pos) noexcept { return data()[pos]; }
+    const pod_t& at(size_t pos) const noexcept { return data()[pos]; }
+
+    pod_t& operator [](size_t pos) noexcept { return at(pos); }
+    const pod_t& operator [](size_t pos) const noexcept { return at(pos); }
+
+    pod_t& front() noexcept { return at(0); }
+    const pod_t& front() const noexcept { return at(0); }
+
+    pod_t& back() noexcept { return at(m_size-1); }
+    const pod_t& back() const noexcept { return at(m_size-1); }
+
+    pod_t* data() noexcept { return (pod_t *)m_file.data(); }
+    const pod_t* data() const noexcept { return (const pod_t *)m_file.data(); }
+
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + m_size; }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + m_size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t max_size() const noexcept { return std::numeric_limits<size_t>::max() / sizeof(pod_t); }
+
+    //the growing members return false, or nullptr for insert and erase, if the file is read only or can not be extended
+    //the vector is then unchanged, unless remapping failed on a system without mremap, which closes the file
+    bool reserve(size_t new_cap) noexcept
+    {
+      if (new_cap <= capacity())return true;
+      if (new_cap > max_size() - 32)
+        return false;
+      return resize(new_cap + (32 - (new_cap % 32)));
+    }
+
+    size_t capacity() const noexcept { return m_file.size() / sizeof(pod_t); }
+
+    void shrink_to_fit() noexcept { resize(m_size); }
+
+    void clear() noexcept { m_size = 0; }
+
+    iterator insert(iterator pos, const pod_t& value) noexcept { return insert(pos, 1, value); }
+    iterator insert(iterator pos, size_t count, const pod_t& value) noexcept
+    {
+      alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+      memcpy(copy, &value, sizeof(pod_t));
+      pos = make_gap(pos, count);
+      if (pos == nullptr)
+        return nullptr;
+      simd_fill(pos, count, *reinterpret_cast<const pod_t *>(copy));
+      return pos;
+    }
+    iterator insert(iterator pos, const_iterator first, const_iterator last) noexcept
+    {
+      //a source inside the mapping could move when it grows
+      assert(first >= end() || last <= begin());
+      size_t count = last - first;
+      pos = make_gap(pos, count);
+      if (pos == nullptr)
+        return nullptr;
+      memcpy(pos, first, count * sizeof(pod_t));
+      return pos;
+    }
+
+    iterator erase(iterator pos) noexcept { return erase(pos, pos + 1); }
+    iterator erase(iterator first, iterator last) noexcept
+    {
+      if (!is_writable())
+        return nullptr;
+      memmove(first, last, (end() - last) * sizeof(pod_t));
+      m_size -= last - first;
+      return first;
+    }
+
+    bool push_back(const pod_t& value) noexcept
+    {
+      if (!is_writable())
+        return false;
+      if (m_size == capacity())
+      {
+        alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+        memcpy(copy, &value, sizeof(pod_t));
+        if (!resize(std::max<size_t>(capacity() * 2, 32)))
+          return false;
+        memcpy(end(), copy, sizeof(pod_t));
+      }
+      else
+        memcpy(end(), &value, sizeof(pod_t));
+      ++m_size;
+      return true;
+    }
+
+    void pop_back() noexcept
+    {
+      --m_size;
+    }
+
+    //sets the capacity, the file is extended with ftruncate and the mapping moved with mremap
+    bool resize(size_t new_cap) noexcept
+    {
+      if (!is_writable() || new_cap > max_size())
+        return false;
+      if (!m_file.resize(new_cap * sizeof(pod_t)))
+      {
+        //only a failed fresh mapping closes the file, ftruncate and mremap failures leave the old mapping
+        if (!m_file.is_open())
+          m_size = 0;
+        return false;
+      }
+      m_size = std::min(new_cap, m_size);
+      return true;
+    }
+
+    bool resize(size_t count, const pod_t &value) noexcept
+    {
+      if (count > m_size)
+        return insert(end(), count - m_size, value) != nullptr;
+      return resize(count);
+    }
+
+    void swap(mmap_pod_vector<pod_t> &other) noexcept
+    {
+      std::swap(m_file, other.m_file);
+      std::swap(m_size, other.m_size);
+    }
+
+  private:
+    //opens count uninitialised elements at pos, nullptr if the file can not be written or grown
+    iterator make_gap(iterator pos, size_t count) noexcept
+    {
+      size_t gap_offset = pos - begin();
+      if (!is_writable() || count > max_size() - m_size)
+        return nullptr;
+      if (count + m_size > capacity() && !resize(std::max(count + m_size, capacity() * 2)))
+        return nullptr;
+      pod_t *gap = data() + gap_offset;
+      memmove(gap + count, gap, (m_size - gap_offset) * sizeof(pod_t));
+      m_size += count;
+      return gap;
+    }
+
+    mapped_file m_file;
+    size_t m_size;
+  };
+}
+#endif
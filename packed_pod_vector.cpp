@@ -0,0 +1,166 @@
+#include "packed_pod_vector.h"
+#include "cpu_features.h"
+
+#if defined(SMALL_TL_X86)
+#include <immintrin.h>
+#endif
+
+namespace small_tl::packing
+{
+  //
+  //scalar
+  //
+
+  //folds the sign into the low bit so small negative deltas pack as small values
+  template<class word_t>
+  static word_t zigzag(word_t delta) noexcept
+  {
+    return (word_t)(delta << 1) ^ (word_t)(0 - (delta >> (sizeof(word_t) * 8 - 1)));
+  }
+
+  template<class word_t>
+  static word_t unzigzag(word_t value) noexcept
+  {
+    return (word_t)(value >> 1) ^ (word_t)(0 - (value & 1));
+  }
+
+  //value i of the block is slot i / 4 of lane i % 4, each lane's slots are packed into a run of words interleaved with the other lanes
+  //so word j of all four lanes is one 16 byte load and every load yields four consecutive values
+  template<class word_t>
+  static uint32_t pack_scalar(const word_t *values, word_t previous, word_t *words) noexcept
+  {
+    const uint32_t word_bits = sizeof(word_t) * 8;
+    word_t deltas[block_size];
+    word_t used_bits = 0;
+    for (size_t i = 0; i < block_size; ++i)
+    {
+      deltas[i] = zigzag((word_t)(values[i] - previous));
+      previous = values[i];
+      used_bits |= deltas[i];
+    }
+
+    uint32_t width = used_bits == 0 ? 0 : highest_set_bit64(used_bits) + 1;
+    memset(words, 0, block_words(width) * sizeof(word_t));
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+      for (size_t slot = 0; slot < block_size / lanes; ++slot)
+      {
+        word_t value = deltas[slot * lanes + lane];
+        size_t bit = slot * width;
+        size_t word = bit / word_bits;
+        uint32_t shift = bit % word_bits;
+        words[word * lanes + lane] |= value << shift;
+        if (shift + width > word_bits)
+          words[(word + 1) * lanes + lane] |= value >> (word_bits - shift);
+      }
+    }
+    return width;
+  }
+
+  template<class word_t>
+  static void unpack_scalar(const word_t *words, uint32_t width, word_t previous, word_t *values) noexcept
+  {
+    const uint32_t word_bits = sizeof(word_t) * 8;
+    if (width == 0)
+    {
+      for (size_t i = 0; i < block_size; ++i)
+        values[i] = previous;
+      return;
+    }
+
+    word_t mask = width == word_bits ? ~(word_t)0 : (word_t)(((word_t)1 << width) - 1);
+    for (size_t lane = 0; lane < lanes; ++lane)
+    {
+      for (size_t slot = 0; slot < block_size / lanes; ++slot)
+      {
+        size_t bit = slot * width;
+        size_t word = bit / word_bits;
+        uint32_t shift = bit % word_bits;
+        word_t value = words[word * lanes + lane] >> shift;
+        if (shift + width > word_bits)
+          value |= words[(word + 1) * lanes + lane] << (word_bits - shift);
+        values[slot * lanes + lane] = value & mask;
+      }
+    }
+
+    for (size_t i = 0; i < block_size; ++i)
+    {
+      previous += unzigzag(values[i]);
+      values[i] = previous;
+    }
+  }
+
+#if defined(SMALL_TL_X86)
+  //
+  //sse2
+  //
+
+  //unpacks four values per step, then undoes the zigzag and the deltas with an in register prefix sum
+  static void unpack_u32_sse2(const uint32_t *words, uint32_t width, uint32_t previous, uint32_t *values) noexcept
+  {
+    if (width == 0)
+    {
+      unpack_scalar(words, width, previous, values);
+      return;
+    }
+
+    const __m128i *src = (const __m128i *)words;
+    const __m128i mask = _mm_set1_epi32(width == 32 ? -1 : (int)((1u << width) - 1));
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i running = _mm_set1_epi32((int)previous);
+    __m128i word = _mm_loadu_si128(src++);
+    uint32_t shift = 0;
+    for (size_t slot = 0; slot < block_size / lanes; ++slot)
+    {
+      __m128i value = _mm_srl_epi32(word, _mm_cvtsi32_si128((int)shift));
+      shift += width;
+      //the lanes hold exactly width words each, so the last slot always ends on a word boundary
+      if (shift >= 32 && slot + 1 < block_size / lanes)
+      {
+        shift -= 32;
+        word = _mm_loadu_si128(src++);
+        if (shift > 0)
+          value = _mm_or_si128(value, _mm_sll_epi32(word, _mm_cvtsi32_si128((int)(width - shift))));
+      }
+      value = _mm_and_si128(value, mask);
+
+      __m128i delta = _mm_xor_si128(_mm_srli_epi32(value, 1), _mm_sub_epi32(zero, _mm_and_si128(value, one)));
+      delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+      delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+      running = _mm_add_epi32(delta, running);
+      _mm_storeu_si128((__m128i *)(values + slot * lanes), running);
+      running = _mm_shuffle_epi32(running, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+  }
+#endif
+
+  //
+  //dispatch
+  //
+
+  typedef void (*unpack_u32_kernel)(const uint32_t *, uint32_t, uint32_t, uint32_t *) noexcept;
+
+  static unpack_u32_kernel select_unpack_u32()
+  {
+#if defined(SMALL_TL_X86)
+    if (get_cpu_features().sse2)
+      return &unpack_u32_sse2;
+#endif
+    return &unpack_scalar<uint32_t>;
+  }
+
+  //
+  //entry points
+  //
+
+  uint32_t pack_block(const uint32_t *values, uint32_t previous, uint32_t *words) noexcept { return pack_scalar(values, previous, words); }
+  uint32_t pack_block(const uint64_t *values, uint64_t previous, uint64_t *words) noexcept { return pack_scalar(values, previous, words); }
+
+  void unpack_block(const uint32_t *words, uint32_t width, uint32_t previous, uint32_t *values) noexcept
+  {
+    static const unpack_u32_kernel selected = select_unpack_u32();
+    selected(words, width, previous, values);
+  }
+  void unpack_block(const uint64_t *words, uint32_t width, uint64_t previous, uint64_t *values) noexcept { unpack_scalar(words, width, previous, values); }
+}
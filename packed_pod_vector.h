@@ -0,0 +1,236 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include "pod_allocator.h"
+#include "pod_vector.h"
+
+namespace small_tl
+{
+  //block coding shared by every packed_pod_vector, see packed_pod_vector.cpp
+  namespace packing
+  {
+    static constexpr size_t block_size = 128;
+    static constexpr size_t lanes = 4;
+
+    //words a block of the given bit width packs into
+    constexpr size_t block_words(uint32_t width) noexcept { return lanes * width; }
+
+    //zigzag deltas from previous, bit packed at the smallest width that holds them all, words must have room for a full width block
+    //returns the width
+    uint32_t pack_block(const uint32_t *values, uint32_t previous, uint32_t *words) noexcept;
+    uint32_t pack_block(const uint64_t *values, uint64_t previous, uint64_t *words) noexcept;
+
+    //decodes all block_size values
+    void unpack_block(const uint32_t *words, uint32_t width, uint32_t previous, uint32_t *values) noexcept;
+    void unpack_block(const uint64_t *words, uint32_t width, uint64_t previous, uint64_t *values) noexcept;
+  }
+
+  //a read only column of integers held as blocks of 128 delta coded, bit packed values
+  //sorted ids and timestamps shrink to a few bits each, any block decodes on its own so random access costs one block
+  //values are appended, the last partial block is kept unpacked until it fills
+  template<class int_t, class allocator_t = pod_malloc_allocator>
+  class packed_pod_vector
+  {
+    static_assert(std::is_integral<int_t>::value, "packed_pod_vector requires an integer type");
+  public:
+    static constexpr size_t block_size = packing::block_size;
+
+    typedef int_t value_type;
+    //64 bit values pack into 64 bit words, everything smaller is widened to 32 bits
+    typedef typename std::conditional<sizeof(int_t) <= 4, uint32_t, uint64_t>::type word_t;
+
+    //carries one decoded block so a walk over the vector decodes each block once
+    class const_iterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef int_t value_type;
+      typedef ptrdiff_t difference_type;
+      typedef int_t reference;
+      typedef const int_t* pointer;
+
+      const_iterator() noexcept : m_owner(nullptr), m_index(0), m_block(no_block) {}
+      const_iterator(const packed_pod_vector *owner, size_t index) noexcept : m_owner(owner), m_index(index), m_block(no_block) {}
+
+      int_t operator*() const noexcept
+      {
+        size_t block = m_index / block_size;
+        if (block != m_block)
+        {
+          m_owner->decode_block(block, m_values);
+          m_block = block;
+        }
+        return m_values[m_index % block_size];
+      }
+      int_t operator[](difference_type offset) const noexcept { return *(*this + offset); }
+
+      const_iterator &operator++() noexcept { ++m_index; return *this; }
+      const_iterator &operator--() noexcept { --m_index; return *this; }
+      const_iterator operator++(int) noexcept { const_iterator previous = *this; ++m_index; return previous; }
+      const_iterator operator--(int) noexcept { const_iterator previous = *this; --m_index; return previous; }
+      const_iterator &operator+=(difference_type offset) noexcept { m_index += offset; return *this; }
+      const_iterator &operator-=(difference_type offset) noexcept { m_index -= offset; return *this; }
+      const_iterator operator+(difference_type offset) const noexcept { const_iterator moved = *this; moved.m_index += offset; return moved; }
+      const_iterator operator-(difference_type offset) const noexcept { const_iterator moved = *this; moved.m_index -= offset; return moved; }
+      difference_type operator-(const const_iterator &other) const noexcept { return (difference_type)m_index - (difference_type)other.m_index; }
+
+      bool operator==(const const_iterator &other) const noexcept { return m_index == other.m_index; }
+      bool operator!=(const const_iterator &other) const noexcept { return m_index != other.m_index; }
+      bool operator<(const const_iterator &other) const noexcept { return m_index < other.m_index; }
+      bool operator>(const const_iterator &other) const noexcept { return m_index > other.m_index; }
+      bool operator<=(const const_iterator &other) const noexcept { return m_index <= other.m_index; }
+      bool operator>=(const const_iterator &other) const noexcept { return m_index >= other.m_index; }
+
+    private:
+      static constexpr size_t no_block = std::numeric_limits<size_t>::max();
+
+      const packed_pod_vector *m_owner;
+      size_t m_index;
+      mutable size_t m_block;
+      mutable int_t m_values[block_size];
+    };
+
+    typedef const_iterator iterator;
+
+    packed_pod_vector() noexcept : packed_pod_vector(allocator_t()) {}
+    explicit packed_pod_vector(const allocator_t &allocator) noexcept : m_blocks(allocator), m_words(allocator), m_tail(allocator), m_last_packed(0), m_size(0) {}
+    packed_pod_vector(const int_t *src, size_t count) noexcept : packed_pod_vector() { append(src, count); }
+    template<class vector_allocator_t, class vector_growth_t>
+    explicit packed_pod_vector(const pod_vector<int_t, vector_allocator_t, vector_growth_t> &vector) noexcept : packed_pod_vector() { append(vector.data(), vector.size()); }
+
+    int_t at(size_t pos) const noexcept
+    {
+      size_t block = pos / block_size;
+      if (block == m_blocks.size())
+        return m_tail[pos % block_size];
+      word_t values[block_size];
+      unpack(block, values);
+      return (int_t)values[pos % block_size];
+    }
+
+    int_t operator [](size_t pos) const noexcept { return at(pos); }
+
+    int_t front() const noexcept { return at(0); }
+    int_t back() const noexcept { return at(m_size - 1); }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, m_size); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t block_count() const noexcept { return (m_size + block_size - 1) / block_size; }
+
+    //bytes held by the encoded blocks, their headers and the unpacked tail
+    size_t packed_bytes() const noexcept { return m_words.size() * sizeof(word_t) + m_blocks.size() * sizeof(block) + m_tail.size() * sizeof(int_t); }
+
+    //writes the values of one block to dst and returns how many there were, block_size for all but the last
+    size_t decode_block(size_t block_index, int_t *dst) const noexcept
+    {
+      if (block_index == m_blocks.size())
+      {
+        memcpy(dst, m_tail.data(), m_tail.size() * sizeof(int_t));
+        return m_tail.size();
+      }
+      if constexpr (sizeof(int_t) == sizeof(word_t))
+        unpack(block_index, (word_t *)dst);
+      else
+      {
+        word_t values[block_size];
+        unpack(block_index, values);
+        for (size_t i = 0; i < block_size; ++i)
+          dst[i] = (int_t)values[i];
+      }
+      return block_size;
+    }
+
+    //writes every value to dst, which must hold size() of them
+    void decode(int_t *dst) const noexcept
+    {
+      for (size_t block_index = 0; block_index < block_count(); ++block_index)
+        dst += decode_block(block_index, dst);
+    }
+
+    void push_back(int_t value) noexcept
+    {
+      m_tail.push_back(value);
+      ++m_size;
+      if (m_tail.size() == block_size)
+        pack_tail();
+    }
+
+    void append(const int_t *src, size_t count) noexcept
+    {
+      while (count > 0)
+      {
+        size_t span = std::min(count, block_size - m_tail.size());
+        m_tail.insert(m_tail.end(), src, src + span);
+        m_size += span;
+        src += span;
+        count -= span;
+        if (m_tail.size() == block_size)
+          pack_tail();
+      }
+    }
+
+    void clear() noexcept
+    {
+      m_blocks.clear();
+      m_words.clear();
+      m_tail.clear();
+      m_last_packed = 0;
+      m_size = 0;
+    }
+
+    void swap(packed_pod_vector &other) noexcept
+    {
+      m_blocks.swap(other.m_blocks);
+      m_words.swap(other.m_words);
+      m_tail.swap(other.m_tail);
+      std::swap(m_last_packed, other.m_last_packed);
+      std::swap(m_size, other.m_size);
+    }
+
+  private:
+    struct block
+    {
+      //the value before the block's first, so every block decodes without its neighbours
+      word_t previous;
+      size_t offset;
+      uint32_t width;
+    };
+
+    void unpack(size_t block_index, word_t *values) const noexcept
+    {
+      const block &header = m_blocks[block_index];
+      packing::unpack_block(m_words.data() + header.offset, header.width, header.previous, values);
+    }
+
+    void pack_tail() noexcept
+    {
+      word_t values[block_size];
+      for (size_t i = 0; i < block_size; ++i)
+        values[i] = (word_t)(typename std::make_unsigned<int_t>::type)m_tail[i];
+
+      word_t words[packing::block_words(sizeof(word_t) * 8)];
+      uint32_t width = packing::pack_block(values, m_last_packed, words);
+      m_blocks.push_back(block{ m_last_packed, m_words.size(), width });
+      m_words.insert(m_words.end(), words, words + packing::block_words(width));
+      m_last_packed = values[block_size - 1];
+      m_tail.clear();
+    }
+
+    pod_vector<block, allocator_t> m_blocks;
+    pod_vector<word_t, allocator_t> m_words;
+    pod_vector<int_t, allocator_t> m_tail;
+    word_t m_last_packed;
+    size_t m_size;
+  };
+}
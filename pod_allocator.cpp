@@ -0,0 +1,267 @@
+#include "pod_allocator.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace small_tl
+{
+#if defined(__linux__)
+  static bool is_mapped(size_t bytes)
+  {
+    return bytes >= pod_malloc_allocator::mremap_threshold;
+  }
+
+  static size_t round_to_pages(size_t bytes)
+  {
+    static const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + page_size - 1) & ~(page_size - 1);
+  }
+#else
+  static bool is_mapped(size_t) { return false; }
+#endif
+
+  void *pod_malloc_allocator::allocate(size_t bytes) noexcept
+  {
+#if defined(__linux__)
+    if (is_mapped(bytes))
+    {
+      void *ptr = mmap(nullptr, round_to_pages(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+#endif
+    return std::malloc(bytes);
+  }
+
+  void *pod_malloc_allocator::reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept
+  {
+    if (ptr == nullptr)
+      return allocate(new_bytes);
+    //shrinking to nothing frees the block, allocate(0) could return nullptr before the old one was released
+    if (new_bytes == 0)
+    {
+      deallocate(ptr, old_bytes);
+      return nullptr;
+    }
+
+#if defined(__linux__)
+    //page tables are rewritten, nothing is copied even if the block moves
+    if (is_mapped(old_bytes) && is_mapped(new_bytes))
+    {
+      void *new_ptr = mremap(ptr, round_to_pages(old_bytes), round_to_pages(new_bytes), MREMAP_MAYMOVE);
+      return new_ptr == MAP_FAILED ? nullptr : new_ptr;
+    }
+#endif
+
+    if (!is_mapped(old_bytes) && !is_mapped(new_bytes))
+    {
+      void *new_ptr = std::realloc(ptr, new_bytes);
+      if (new_ptr != ptr && new_ptr != nullptr)
+        bytes_copied += std::min(old_bytes, new_bytes);
+      return new_ptr;
+    }
+
+    //crossing the threshold changes the kind of block, so it has to be copied
+    void *new_ptr = allocate(new_bytes);
+    if (new_ptr == nullptr)
+      return nullptr;
+    size_t preserved = std::min(old_bytes, new_bytes);
+    memcpy(new_ptr, ptr, preserved);
+    bytes_copied += preserved;
+    deallocate(ptr, old_bytes);
+    return new_ptr;
+  }
+
+  void pod_malloc_allocator::deallocate(void *ptr, size_t bytes) noexcept
+  {
+    if (ptr == nullptr)
+      return;
+#if defined(__linux__)
+    if (is_mapped(bytes))
+    {
+      munmap(ptr, round_to_pages(bytes));
+      return;
+    }
+#endif
+    std::free(ptr);
+  }
+
+#if defined(__linux__)
+  static size_t round_to_huge_pages(size_t bytes)
+  {
+    return (bytes + pod_aligned_allocator::huge_page_size - 1) & ~(pod_aligned_allocator::huge_page_size - 1);
+  }
+
+  //reserves inaccessible address space starting on a huge page boundary
+  static char *reserve_huge_aligned(size_t bytes)
+  {
+    size_t reserved = bytes + pod_aligned_allocator::huge_page_size;
+    char *base = (char *)mmap(nullptr, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED)
+      return nullptr;
+    char *aligned = (char *)(((uintptr_t)base + pod_aligned_allocator::huge_page_size - 1) & ~(uintptr_t)(pod_aligned_allocator::huge_page_size - 1));
+    if (aligned != base)
+      munmap(base, aligned - base);
+    size_t tail = (base + reserved) - (aligned + bytes);
+    if (tail != 0)
+      munmap(aligned + bytes, tail);
+    return aligned;
+  }
+
+  static void advise_huge_pages(void *ptr, size_t bytes)
+  {
+#if defined(MADV_HUGEPAGE)
+    madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+  }
+
+  static void *map_huge(size_t bytes)
+  {
+    size_t mapped = round_to_huge_pages(bytes);
+    char *ptr = reserve_huge_aligned(mapped);
+    if (ptr == nullptr)
+      return nullptr;
+    if (mmap(ptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+    {
+      munmap(ptr, mapped);
+      return nullptr;
+    }
+    advise_huge_pages(ptr, mapped);
+    return ptr;
+  }
+
+  //moves the pages rather than the bytes, and onto a huge page boundary when it can not grow in place
+  static void *remap_huge(void *ptr, size_t old_bytes, size_t new_bytes)
+  {
+    size_t old_mapped = round_to_huge_pages(old_bytes);
+    size_t new_mapped = round_to_huge_pages(new_bytes);
+    if (new_mapped == old_mapped)
+      return ptr;
+    if (new_mapped < old_mapped)
+    {
+      munmap((char *)ptr + new_mapped, old_mapped - new_mapped);
+      return ptr;
+    }
+
+    if (mremap(ptr, old_mapped, new_mapped, 0) != MAP_FAILED)
+    {
+      advise_huge_pages(ptr, new_mapped);
+      return ptr;
+    }
+
+    char *target = reserve_huge_aligned(new_mapped);
+    if (target == nullptr)
+      return nullptr;
+    void *moved = mremap(ptr, old_mapped, new_mapped, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+    if (moved == MAP_FAILED)
+    {
+      munmap(target, new_mapped);
+      return nullptr;
+    }
+    advise_huge_pages(moved, new_mapped);
+    return moved;
+  }
+#endif
+
+  void *pod_aligned_allocator::allocate(size_t bytes) noexcept
+  {
+#if defined(__linux__)
+    if (bytes >= huge_page_threshold)
+      return map_huge(bytes);
+#endif
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void *ptr = nullptr;
+    return posix_memalign(&ptr, alignment, bytes) == 0 ? ptr : nullptr;
+#endif
+  }
+
+  void *pod_aligned_allocator::reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept
+  {
+    if (ptr == nullptr)
+      return allocate(new_bytes);
+    if (new_bytes == 0)
+    {
+      deallocate(ptr, old_bytes);
+      return nullptr;
+    }
+
+#if defined(__linux__)
+    if (old_bytes >= huge_page_threshold && new_bytes >= huge_page_threshold)
+      return remap_huge(ptr, old_bytes, new_bytes);
+#endif
+
+    //there is no aligned realloc, so smaller blocks always move
+    void *new_ptr = allocate(new_bytes);
+    if (new_ptr == nullptr)
+      return nullptr;
+    size_t preserved = std::min(old_bytes, new_bytes);
+    memcpy(new_ptr, ptr, preserved);
+    bytes_copied += preserved;
+    deallocate(ptr, old_bytes);
+    return new_ptr;
+  }
+
+  void pod_aligned_allocator::deallocate(void *ptr, size_t bytes) noexcept
+  {
+    if (ptr == nullptr)
+      return;
+#if defined(__linux__)
+    if (bytes >= huge_page_threshold)
+    {
+      munmap(ptr, round_to_huge_pages(bytes));
+      return;
+    }
+#endif
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+  }
+
+  //memory resources throw when they run out, the allocator concept returns nullptr instead
+  void *pod_pmr_allocator::allocate(size_t bytes) noexcept
+  {
+    if (bytes == 0)
+      return nullptr;
+    try
+    {
+      return resource->allocate(bytes);
+    }
+    catch (const std::bad_alloc &)
+    {
+      return nullptr;
+    }
+  }
+
+  void *pod_pmr_allocator::reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept
+  {
+    if (old_bytes == new_bytes)
+      return ptr;
+    void *new_ptr = allocate(new_bytes);
+    if (new_ptr == nullptr && new_bytes != 0)
+      return nullptr;
+    size_t preserved = std::min(old_bytes, new_bytes);
+    if (ptr != nullptr)
+    {
+      memcpy(new_ptr, ptr, preserved);
+      bytes_copied += preserved;
+    }
+    deallocate(ptr, old_bytes);
+    return new_ptr;
+  }
+
+  void pod_pmr_allocator::deallocate(void *ptr, size_t bytes) noexcept
+  {
+    if (ptr != nullptr)
+      resource->deallocate(ptr, bytes);
+  }
+}
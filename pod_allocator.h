@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+namespace small_tl
+{
+  //the default pod storage, malloc backed blocks that grow with realloc
+  //blocks over the mremap threshold are mapped instead, so growing them moves pages rather than copying bytes
+  struct pod_malloc_allocator
+  {
+    static constexpr size_t mremap_threshold = 4 * 1024 * 1024;
+
+    void *allocate(size_t bytes) noexcept;
+
+    //grows or shrinks a block, preserving the first min(old_bytes, new_bytes) bytes
+    //bytes_copied is increased by the number of bytes that had to be physically copied
+    void *reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept;
+
+    void deallocate(void *ptr, size_t bytes) noexcept;
+  };
+
+  //cache line aligned storage, so simd loads never split a line and neighbouring blocks never share one
+  //blocks over the huge page threshold are huge page aligned mappings advised for transparent huge pages and grown with mremap
+  struct pod_aligned_allocator
+  {
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+    //a power of two, at least sizeof(void *)
+    size_t alignment = 64;
+    size_t huge_page_threshold = 4 * 1024 * 1024;
+
+    void *allocate(size_t bytes) noexcept;
+    void *reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept;
+    void deallocate(void *ptr, size_t bytes) noexcept;
+  };
+
+  //adapts a std::pmr::memory_resource, growth always allocates a new block and copies
+  struct pod_pmr_allocator
+  {
+    std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+
+    void *allocate(size_t bytes) noexcept;
+    void *reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept;
+    void deallocate(void *ptr, size_t bytes) noexcept;
+  };
+}
@@ -0,0 +1,127 @@
+#include "pod_arena.h"
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+#include <limits>
+
+namespace small_tl
+{
+  struct pod_arena::chunk
+  {
+    chunk *previous;
+    size_t size;
+  };
+
+  static char *align_up(char *ptr, size_t alignment)
+  {
+    return (char *)(((uintptr_t)ptr + alignment - 1) & ~(uintptr_t)(alignment - 1));
+  }
+
+  pod_arena::pod_arena(size_t initial_chunk_size) noexcept :
+    m_chunk(nullptr), m_cursor(nullptr), m_end(nullptr), m_last(nullptr), m_next_chunk_size(initial_chunk_size), m_bytes_allocated(0)
+  {}
+
+  pod_arena::~pod_arena()
+  {
+    release();
+  }
+
+  void *pod_arena::do_allocate(size_t bytes, size_t alignment)
+  {
+    char *ptr = align_up(m_cursor, alignment);
+    if (m_cursor == nullptr || ptr > m_end || bytes > (size_t)(m_end - ptr))
+    {
+      //a size the chunk header and alignment would wrap can never be met
+      if (bytes > std::numeric_limits<size_t>::max() - sizeof(chunk) - alignment)
+        throw std::bad_alloc();
+      //chunks double so a growing allocation that keeps spilling over costs amortised constant copies
+      size_t chunk_size = std::max(m_next_chunk_size, sizeof(chunk) + alignment + bytes);
+      chunk *new_chunk = (chunk *)std::malloc(chunk_size);
+      if (new_chunk == nullptr)
+        throw std::bad_alloc();
+      new_chunk->previous = m_chunk;
+      new_chunk->size = chunk_size;
+      m_chunk = new_chunk;
+      m_end = (char *)new_chunk + chunk_size;
+      m_next_chunk_size = chunk_size * 2;
+      ptr = align_up((char *)(new_chunk + 1), alignment);
+    }
+
+    m_cursor = ptr + bytes;
+    m_last = ptr;
+    m_bytes_allocated += bytes;
+    return ptr;
+  }
+
+  void pod_arena::do_deallocate(void *ptr, size_t bytes, size_t)
+  {
+    //only the top of the stack can be handed back, everything else waits for release
+    if (ptr == m_last)
+    {
+      m_cursor = m_last;
+      m_last = nullptr;
+      m_bytes_allocated -= bytes;
+    }
+  }
+
+  bool pod_arena::try_resize(void *ptr, size_t old_bytes, size_t new_bytes) noexcept
+  {
+    if (ptr == nullptr || ptr != m_last || new_bytes > (size_t)(m_end - (char *)ptr))
+      return false;
+    m_cursor = (char *)ptr + new_bytes;
+    m_bytes_allocated += new_bytes - old_bytes;
+    return true;
+  }
+
+  void pod_arena::release() noexcept
+  {
+    while (m_chunk != nullptr)
+    {
+      chunk *previous = m_chunk->previous;
+      std::free(m_chunk);
+      m_chunk = previous;
+    }
+    m_cursor = m_end = m_last = nullptr;
+    m_bytes_allocated = 0;
+  }
+
+  pod_arena_allocator::pod_arena_allocator(pod_arena &arena) noexcept : arena(&arena) {}
+
+  //do_allocate throws when malloc fails, the allocator concept returns nullptr instead
+  void *pod_arena_allocator::allocate(size_t bytes) noexcept
+  {
+    try
+    {
+      return arena->allocate(bytes, alignof(std::max_align_t));
+    }
+    catch (const std::bad_alloc &)
+    {
+      return nullptr;
+    }
+  }
+
+  void *pod_arena_allocator::reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept
+  {
+    if (arena->try_resize(ptr, old_bytes, new_bytes))
+      return ptr;
+
+    void *new_ptr = allocate(new_bytes);
+    if (new_ptr == nullptr)
+      return nullptr;
+    if (ptr != nullptr)
+    {
+      size_t preserved = std::min(old_bytes, new_bytes);
+      memcpy(new_ptr, ptr, preserved);
+      bytes_copied += preserved;
+    }
+    return new_ptr;
+  }
+
+  void pod_arena_allocator::deallocate(void *ptr, size_t bytes) noexcept
+  {
+    if (ptr != nullptr)
+      arena->deallocate(ptr, bytes, alignof(std::max_align_t));
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <memory_resource>
+
+namespace small_tl
+{
+  //a monotonic bump pointer arena, everything allocated from it is freed at once by release or destruction
+  //the most recent allocation can be grown or shrunk in place and is reclaimed if it is deallocated
+  class pod_arena : public std::pmr::memory_resource
+  {
+    pod_arena(const pod_arena &) = delete;
+    pod_arena &operator=(const pod_arena &) = delete;
+
+  public:
+    explicit pod_arena(size_t initial_chunk_size = 64 * 1024) noexcept;
+    ~pod_arena();
+
+    //grows or shrinks ptr to new_bytes without moving it, only possible for the most recent allocation
+    bool try_resize(void *ptr, size_t old_bytes, size_t new_bytes) noexcept;
+
+    //frees every chunk, invalidating all allocations
+    void release() noexcept;
+
+    size_t bytes_allocated() const noexcept { return m_bytes_allocated; }
+
+  private:
+    struct chunk;
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    chunk *m_chunk;
+    char *m_cursor;
+    char *m_end;
+    char *m_last;
+    size_t m_next_chunk_size;
+    size_t m_bytes_allocated;
+  };
+
+  //pod_vector storage drawn from a pod_arena, a vector that is the arena's latest allocation grows without copying
+  //there is no default constructor, so containers given this allocator must be given an arena too
+  struct pod_arena_allocator
+  {
+    explicit pod_arena_allocator(pod_arena &arena) noexcept;
+
+    pod_arena *arena;
+
+    void *allocate(size_t bytes) noexcept;
+    void *reallocate(void *ptr, size_t old_bytes, size_t new_bytes, size_t &bytes_copied) noexcept;
+    void deallocate(void *ptr, size_t bytes) noexcept;
+  };
+}
@@ -0,0 +1,289 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include "pod_allocator.h"
+#include "pod_ring_buffer.h"
+
+namespace small_tl
+{
+  //a growable double ended queue of fixed size chunks, the chunk map is a pod_ring_buffer so both ends push and pop in O(1)
+  //growth never moves elements and one spare chunk is kept so a steady fifo does not allocate
+  //the growing members return false if a chunk or the chunk map can not be allocated, the deque is then unchanged
+  template<class pod_t, size_t chunk_bytes = 4096, class allocator_t = pod_malloc_allocator>
+  class pod_deque
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "pod_deque requires a trivial type");
+  public:
+    static constexpr size_t chunk_elements = sizeof(pod_t) < chunk_bytes ? chunk_bytes / sizeof(pod_t) : 1;
+
+    typedef pod_t value_type;
+
+    template<class owner_t, class element_t>
+    class basic_iterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef pod_t value_type;
+      typedef ptrdiff_t difference_type;
+      typedef element_t& reference;
+      typedef element_t* pointer;
+
+      basic_iterator() noexcept : m_owner(nullptr), m_index(0) {}
+      basic_iterator(owner_t *owner, size_t index) noexcept : m_owner(owner), m_index(index) {}
+
+      reference operator*() const noexcept { return (*m_owner)[m_index]; }
+      pointer operator->() const noexcept { return &(*m_owner)[m_index]; }
+      reference operator[](difference_type offset) const noexcept { return (*m_owner)[m_index + offset]; }
+
+      basic_iterator &operator++() noexcept { ++m_index; return *this; }
+      basic_iterator &operator--() noexcept { --m_index; return *this; }
+      basic_iterator operator++(int) noexcept { basic_iterator previous = *this; ++m_index; return previous; }
+      basic_iterator operator--(int) noexcept { basic_iterator previous = *this; --m_index; return previous; }
+      basic_iterator &operator+=(difference_type offset) noexcept { m_index += offset; return *this; }
+      basic_iterator &operator-=(difference_type offset) noexcept { m_index -= offset; return *this; }
+      basic_iterator operator+(difference_type offset) const noexcept { return basic_iterator(m_owner, m_index + offset); }
+      basic_iterator operator-(difference_type offset) const noexcept { return basic_iterator(m_owner, m_index - offset); }
+      difference_type operator-(const basic_iterator &other) const noexcept { return (difference_type)m_index - (difference_type)other.m_index; }
+
+      bool operator==(const basic_iterator &other) const noexcept { return m_index == other.m_index; }
+      bool operator!=(const basic_iterator &other) const noexcept { return m_index != other.m_index; }
+      bool operator<(const basic_iterator &other) const noexcept { return m_index < other.m_index; }
+      bool operator>(const basic_iterator &other) const noexcept { return m_index > other.m_index; }
+      bool operator<=(const basic_iterator &other) const noexcept { return m_index <= other.m_index; }
+      bool operator>=(const basic_iterator &other) const noexcept { return m_index >= other.m_index; }
+
+    private:
+      owner_t *m_owner;
+      size_t m_index;
+    };
+
+    typedef basic_iterator<pod_deque, pod_t> iterator;
+    typedef basic_iterator<const pod_deque, const pod_t> const_iterator;
+
+    pod_deque() noexcept : pod_deque(allocator_t()) {}
+    explicit pod_deque(const allocator_t &allocator) noexcept : m_allocator(allocator), m_chunks(allocator), m_spare(nullptr), m_front_offset(0), m_size(0) {}
+
+    pod_deque(const pod_deque &) = delete;
+    pod_deque &operator=(const pod_deque &) = delete;
+
+    pod_deque(pod_deque &&other) noexcept : m_allocator(other.m_allocator), m_chunks(std::move(other.m_chunks)), m_spare(other.m_spare), m_front_offset(other.m_front_offset), m_size(other.m_size)
+    {
+      other.m_spare = nullptr;
+      other.m_front_offset = other.m_size = 0;
+    }
+    pod_deque &operator=(pod_deque &&other) noexcept
+    {
+      pod_deque moved(std::move(other));
+      swap(moved);
+      return *this;
+    }
+
+    ~pod_deque()
+    {
+      while (!m_chunks.empty())
+      {
+        free_chunk(m_chunks.back());
+        m_chunks.pop_back();
+      }
+      free_chunk(m_spare);
+    }
+
+    pod_t& at(size_t pos) noexcept
+    {
+      size_t index = m_front_offset + pos;
+      return m_chunks[index / chunk_elements][index % chunk_elements];
+    }
+    const pod_t& at(size_t pos) const noexcept
+    {
+      size_t index = m_front_offset + pos;
+      return m_chunks[index / chunk_elements][index % chunk_elements];
+    }
+
+    pod_t& operator [](size_t pos) noexcept { return at(pos); }
+    const pod_t& operator [](size_t pos) const noexcept { return at(pos); }
+
+    pod_t& front() noexcept { return at(0); }
+    const pod_t& front() const noexcept { return at(0); }
+
+    pod_t& back() noexcept { return at(m_size - 1); }
+    const pod_t& back() const noexcept { return at(m_size - 1); }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, m_size); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, m_size); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_t size() const noexcept { return m_size; }
+
+    void clear() noexcept
+    {
+      while (!m_chunks.empty())
+      {
+        release_chunk(m_chunks.back());
+        m_chunks.pop_back();
+      }
+      m_front_offset = m_size = 0;
+    }
+
+    bool push_back(const pod_t &value) noexcept
+    {
+      size_t index = m_front_offset + m_size;
+      if (index == m_chunks.size() * chunk_elements && !push_back_chunk())
+        return false;
+      memcpy(&m_chunks[index / chunk_elements][index % chunk_elements], &value, sizeof(pod_t));
+      ++m_size;
+      return true;
+    }
+
+    bool push_front(const pod_t &value) noexcept
+    {
+      if (m_front_offset == 0)
+      {
+        if (!push_front_chunk())
+          return false;
+        m_front_offset = chunk_elements;
+      }
+      --m_front_offset;
+      ++m_size;
+      memcpy(&front(), &value, sizeof(pod_t));
+      return true;
+    }
+
+    void pop_front() noexcept
+    {
+      ++m_front_offset;
+      --m_size;
+      if (m_front_offset == chunk_elements || m_size == 0)
+      {
+        release_chunk(m_chunks.front());
+        m_chunks.pop_front();
+        m_front_offset = 0;
+        if (m_size == 0)
+          clear();
+      }
+    }
+
+    void pop_back() noexcept
+    {
+      --m_size;
+      size_t end_index = m_front_offset + m_size;
+      if (end_index <= (m_chunks.size() - 1) * chunk_elements)
+      {
+        release_chunk(m_chunks.back());
+        m_chunks.pop_back();
+      }
+      if (m_size == 0)
+        clear();
+    }
+
+    //appends count elements from src, one memcpy per chunk touched
+    bool enqueue(const pod_t *src, size_t count) noexcept
+    {
+      size_t old_size = m_size;
+      while (count > 0)
+      {
+        size_t index = m_front_offset + m_size;
+        if (index == m_chunks.size() * chunk_elements && !push_back_chunk())
+        {
+          //give back what this call appended, which also returns its chunks
+          while (m_size > old_size)
+            pop_back();
+          return false;
+        }
+        size_t offset = index % chunk_elements;
+        size_t span = std::min(count, chunk_elements - offset);
+        memcpy(m_chunks[index / chunk_elements] + offset, src, span * sizeof(pod_t));
+        m_size += span;
+        src += span;
+        count -= span;
+      }
+      return true;
+    }
+
+    //removes up to count elements from the front into dst, one memcpy per chunk touched
+    size_t dequeue(pod_t *dst, size_t count) noexcept
+    {
+      count = std::min(count, m_size);
+      size_t remaining = count;
+      while (remaining > 0)
+      {
+        size_t span = std::min(remaining, chunk_elements - m_front_offset);
+        memcpy(dst, m_chunks.front() + m_front_offset, span * sizeof(pod_t));
+        dst += span;
+        remaining -= span;
+        m_front_offset += span - 1;
+        m_size -= span - 1;
+        pop_front();
+      }
+      return count;
+    }
+
+    void swap(pod_deque &other) noexcept
+    {
+      std::swap(m_allocator, other.m_allocator);
+      m_chunks.swap(other.m_chunks);
+      std::swap(m_spare, other.m_spare);
+      std::swap(m_front_offset, other.m_front_offset);
+      std::swap(m_size, other.m_size);
+    }
+
+  private:
+    //nullptr if the allocator can not provide a chunk
+    pod_t *acquire_chunk() noexcept
+    {
+      pod_t *chunk = m_spare;
+      m_spare = nullptr;
+      if (chunk == nullptr)
+        chunk = (pod_t *)m_allocator.allocate(chunk_elements * sizeof(pod_t));
+      return chunk;
+    }
+
+    //a chunk the map could not take goes back to the spare
+    bool push_back_chunk() noexcept
+    {
+      pod_t *chunk = acquire_chunk();
+      if (chunk == nullptr)
+        return false;
+      if (m_chunks.push_back(chunk))
+        return true;
+      release_chunk(chunk);
+      return false;
+    }
+
+    bool push_front_chunk() noexcept
+    {
+      pod_t *chunk = acquire_chunk();
+      if (chunk == nullptr)
+        return false;
+      if (m_chunks.push_front(chunk))
+        return true;
+      release_chunk(chunk);
+      return false;
+    }
+
+    void release_chunk(pod_t *chunk) noexcept
+    {
+      if (m_spare == nullptr)
+        m_spare = chunk;
+      else
+        free_chunk(chunk);
+    }
+
+    void free_chunk(pod_t *chunk) noexcept
+    {
+      m_allocator.deallocate(chunk, chunk_elements * sizeof(pod_t));
+    }
+
+    allocator_t m_allocator;
+    pod_ring_buffer<pod_t *, allocator_t> m_chunks;
+    pod_t *m_spare;
+    size_t m_front_offset;
+    size_t m_size;
+  };
+}
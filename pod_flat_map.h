@@ -0,0 +1,181 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstring>
+#include "pod_allocator.h"
+#include "pod_vector.h"
+#include "pod_span.h"
+#include "pod_flat_set.h"
+
+namespace small_tl
+{
+  //unique keys kept sorted in one pod_vector with their values at the same positions in another
+  //searches only touch the keys, build_search_index adds an eytzinger copy of them for read mostly maps
+  template<class key_t, class value_t, class compare_t = std::less<key_t>, class allocator_t = pod_malloc_allocator>
+  class pod_flat_map
+  {
+    static_assert(std::is_trivially_copyable<key_t>::value && std::is_trivially_copyable<value_t>::value, "pod_flat_map requires trivial types");
+  public:
+
+    typedef key_t key_type;
+    typedef value_t mapped_type;
+
+    pod_flat_map() noexcept : pod_flat_map(compare_t(), allocator_t()) {}
+    explicit pod_flat_map(const compare_t &compare, const allocator_t &allocator = allocator_t()) noexcept : m_compare(compare), m_keys(allocator), m_values(allocator), m_index(allocator) {}
+    //keys may be unsorted and repeated, the first value given for a key is kept
+    pod_flat_map(const key_t *keys, const value_t *values, size_t count) noexcept : pod_flat_map() { assign(keys, values, count); }
+
+    void assign(const key_t *keys, const value_t *values, size_t count) noexcept
+    {
+      clear();
+      insert(keys, values, count);
+    }
+
+    //a pointer to the value stored under key and whether it was inserted, an existing value is left alone
+    std::pair<value_t*, bool> insert(const key_t &key, const value_t &value) noexcept
+    {
+      size_t pos = lower_bound_index(key);
+      if (pos != size() && !m_compare(key, m_keys[pos]))
+        return std::make_pair(&m_values[pos], false);
+      m_index.clear();
+      m_keys.insert(m_keys.begin() + pos, key);
+      m_values.insert(m_values.begin() + pos, value);
+      return std::make_pair(&m_values[pos], true);
+    }
+
+    //sorts the batch and merges it in from the back, one pass over the existing entries however many are added
+    void insert(const key_t *keys, const value_t *values, size_t count) noexcept
+    {
+      if (count == 0)return;
+      m_index.clear();
+      pod_vector<entry, allocator_t> batch(m_keys.get_allocator());
+      batch.reserve(count);
+      for (size_t i = 0; i < count; ++i)
+        batch.push_back(entry{ keys[i], values[i] });
+      std::stable_sort(batch.begin(), batch.end(), [this](const entry &lhs, const entry &rhs) { return m_compare(lhs.key, rhs.key); });
+
+      size_t old_size = size();
+      m_keys.insert(m_keys.end(), count, batch[0].key);
+      m_values.insert(m_values.end(), count, batch[0].value);
+      key_t *merged_keys = m_keys.data();
+      value_t *merged_values = m_values.data();
+      size_t i = old_size;
+      size_t j = count;
+      size_t k = old_size + count;
+      while (j > 0)
+      {
+        //on a tie the new entry goes last, so the unique pass keeps the one that was there first
+        --k;
+        if (i > 0 && m_compare(batch[j - 1].key, merged_keys[i - 1]))
+        {
+          --i;
+          merged_keys[k] = merged_keys[i];
+          merged_values[k] = merged_values[i];
+        }
+        else
+        {
+          --j;
+          merged_keys[k] = batch[j].key;
+          merged_values[k] = batch[j].value;
+        }
+      }
+      remove_repeats();
+    }
+
+    size_t erase(const key_t &key) noexcept
+    {
+      size_t pos = lower_bound_index(key);
+      if (pos == size() || m_compare(key, m_keys[pos]))
+        return 0;
+      m_index.clear();
+      m_keys.erase(m_keys.begin() + pos);
+      m_values.erase(m_values.begin() + pos);
+      return 1;
+    }
+
+    //the position of the first key not less than key, size() if there is none
+    size_t lower_bound_index(const key_t &key) const noexcept
+    {
+      if (!m_index.empty())
+        return m_index.lower_bound(key, m_compare);
+      return std::lower_bound(m_keys.begin(), m_keys.end(), key, m_compare) - m_keys.begin();
+    }
+
+    //nullptr when the key is missing
+    value_t *find(const key_t &key) noexcept
+    {
+      size_t pos = lower_bound_index(key);
+      return pos != size() && !m_compare(key, m_keys[pos]) ? &m_values[pos] : nullptr;
+    }
+    const value_t *find(const key_t &key) const noexcept
+    {
+      size_t pos = lower_bound_index(key);
+      return pos != size() && !m_compare(key, m_keys[pos]) ? &m_values[pos] : nullptr;
+    }
+
+    bool contains(const key_t &key) const noexcept { return find(key) != nullptr; }
+    size_t count(const key_t &key) const noexcept { return contains(key) ? 1 : 0; }
+
+    //inserts a value initialised entry when the key is missing
+    value_t& operator [](const key_t &key) noexcept { return *insert(key, value_t()).first; }
+
+    //lays out a breadth first copy of the keys for faster lookups until the next change
+    void build_search_index() noexcept { m_index.build(m_keys.data(), m_keys.size()); }
+    bool has_search_index() const noexcept { return !m_index.empty(); }
+
+    //the sorted keys and the values at the matching positions
+    pod_span<const key_t> keys() const noexcept { return pod_span<const key_t>(m_keys.data(), m_keys.size()); }
+    pod_span<value_t> values() noexcept { return pod_span<value_t>(m_values.data(), m_values.size()); }
+    pod_span<const value_t> values() const noexcept { return pod_span<const value_t>(m_values.data(), m_values.size()); }
+
+    bool empty() const noexcept { return m_keys.empty(); }
+
+    size_t size() const noexcept { return m_keys.size(); }
+
+    void reserve(size_t new_cap) noexcept
+    {
+      m_keys.reserve(new_cap);
+      m_values.reserve(new_cap);
+    }
+
+    void clear() noexcept
+    {
+      m_index.clear();
+      m_keys.clear();
+      m_values.clear();
+    }
+
+  private:
+    struct entry
+    {
+      key_t key;
+      value_t value;
+    };
+
+    //keeps the first of each run of equal keys
+    void remove_repeats() noexcept
+    {
+      key_t *keys = m_keys.data();
+      value_t *values = m_values.data();
+      size_t count = size();
+      size_t kept = 1;
+      for (size_t i = 1; i < count; ++i)
+      {
+        if (!m_compare(keys[kept - 1], keys[i]))
+          continue;
+        keys[kept] = keys[i];
+        values[kept] = values[i];
+        ++kept;
+      }
+      m_keys.erase(m_keys.begin() + kept, m_keys.end());
+      m_values.erase(m_values.begin() + kept, m_values.end());
+    }
+
+    compare_t m_compare;
+    pod_vector<key_t, allocator_t> m_keys;
+    pod_vector<value_t, allocator_t> m_values;
+    flat::eytzinger_index<key_t, compare_t, allocator_t> m_index;
+  };
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include "cpu_features.h"
+#include "pod_allocator.h"
+#include "pod_vector.h"
+
+namespace small_tl
+{
+  namespace flat
+  {
+    //a copy of sorted keys in breadth first order, node k has children 2k and 2k+1 and the root is 1
+    //a search walks the array top down, so the first levels share cache lines and deeper nodes are prefetched ahead of use
+    template<class key_t, class compare_t, class allocator_t>
+    class eytzinger_index
+    {
+    public:
+      explicit eytzinger_index(const allocator_t &allocator) noexcept : m_keys(allocator), m_positions(allocator) {}
+
+      bool empty() const noexcept { return m_keys.empty(); }
+
+      void clear() noexcept
+      {
+        m_keys.clear();
+        m_positions.clear();
+      }
+
+      void build(const key_t *sorted, size_t count) noexcept
+      {
+        clear();
+        if (count == 0)return;
+        //slot 0 is unused so the child arithmetic stays a shift
+        m_keys.insert(m_keys.end(), count + 1, sorted[0]);
+        m_positions.insert(m_positions.end(), count + 1, 0);
+        size_t next = 0;
+        fill(sorted, 1, next);
+      }
+
+      //the sorted position of the first key not less than key, count if there is none
+      size_t lower_bound(const key_t &key, const compare_t &compare) const noexcept
+      {
+        const key_t *keys = m_keys.data();
+        size_t count = m_keys.size() - 1;
+        size_t k = 1;
+        while (k <= count)
+        {
+          //the node four levels down from k, the cache line that holds it also holds its siblings
+          prefetch((const char *)keys + k * prefetch_stride * sizeof(key_t));
+          k = 2 * k + (size_t)compare(keys[k], key);
+        }
+        //k went right past the answer once for every trailing one bit, dropping them and one more step gives the answer
+        k >>= count_trailing_zeros64(~(uint64_t)k) + 1;
+        return k == 0 ? count : m_positions[k];
+      }
+
+    private:
+      static constexpr size_t prefetch_stride = sizeof(key_t) < 64 ? 64 / sizeof(key_t) : 1;
+
+      //an in order walk of the tree hands out the sorted keys in order
+      void fill(const key_t *sorted, size_t k, size_t &next) noexcept
+      {
+        if (k >= m_keys.size())return;
+        fill(sorted, 2 * k, next);
+        m_keys[k] = sorted[next];
+        m_positions[k] = next++;
+        fill(sorted, 2 * k + 1, next);
+      }
+
+      pod_vector<key_t, allocator_t> m_keys;
+      pod_vector<size_t, allocator_t> m_positions;
+    };
+  }
+
+  //unique keys kept sorted in a pod_vector, lookups are binary searches over contiguous memory
+  //build_search_index adds an eytzinger copy of the keys for read mostly sets, any change drops it again
+  template<class key_t, class compare_t = std::less<key_t>, class allocator_t = pod_malloc_allocator>
+  class pod_flat_set
+  {
+    static_assert(std::is_trivially_copyable<key_t>::value, "pod_flat_set requires a trivial type");
+  public:
+
+    typedef key_t value_type;
+    typedef key_t key_type;
+    typedef const key_t* iterator;
+    typedef const key_t* const_iterator;
+
+    pod_flat_set() noexcept : pod_flat_set(compare_t(), allocator_t()) {}
+    explicit pod_flat_set(const compare_t &compare, const allocator_t &allocator = allocator_t()) noexcept : m_compare(compare), m_keys(allocator), m_index(allocator) {}
+    //keys may be unsorted and repeated
+    pod_flat_set(const key_t *first, const key_t *last) noexcept : pod_flat_set() { assign(first, last); }
+
+    void assign(const key_t *first, const key_t *last) noexcept
+    {
+      m_index.clear();
+      m_keys.clear();
+      m_keys.insert(m_keys.end(), first, last);
+      std::sort(m_keys.begin(), m_keys.end(), m_compare);
+      m_keys.erase(std::unique(m_keys.begin(), m_keys.end(), equivalent()), m_keys.end());
+    }
+
+    std::pair<const_iterator, bool> insert(const key_t &key) noexcept
+    {
+      key_t *pos = m_keys.begin() + (lower_bound(key) - begin());
+      if (pos != m_keys.end() && !m_compare(key, *pos))
+        return std::make_pair(pos, false);
+      m_index.clear();
+      return std::make_pair(m_keys.insert(pos, key), true);
+    }
+
+    //sorts the batch and merges it in from the back, one pass over the existing keys however many are added
+    void insert(const key_t *first, const key_t *last) noexcept
+    {
+      if (first == last)return;
+      m_index.clear();
+      pod_vector<key_t, allocator_t> batch(m_keys.get_allocator());
+      batch.insert(batch.end(), first, last);
+      std::stable_sort(batch.begin(), batch.end(), m_compare);
+
+      size_t old_size = m_keys.size();
+      m_keys.insert(m_keys.end(), batch.begin(), batch.end());
+      key_t *keys = m_keys.data();
+      size_t i = old_size;
+      size_t j = batch.size();
+      size_t k = old_size + j;
+      while (j > 0)
+      {
+        //on a tie the new key goes last, so the unique pass keeps the existing one
+        if (i > 0 && m_compare(batch[j - 1], keys[i - 1]))
+          keys[--k] = keys[--i];
+        else
+          keys[--k] = batch[--j];
+      }
+      m_keys.erase(std::unique(m_keys.begin(), m_keys.end(), equivalent()), m_keys.end());
+    }
+
+    size_t erase(const key_t &key) noexcept
+    {
+      key_t *pos = m_keys.begin() + (lower_bound(key) - begin());
+      if (pos == m_keys.end() || m_compare(key, *pos))
+        return 0;
+      m_index.clear();
+      m_keys.erase(pos);
+      return 1;
+    }
+
+    const_iterator lower_bound(const key_t &key) const noexcept
+    {
+      if (!m_index.empty())
+        return begin() + m_index.lower_bound(key, m_compare);
+      return std::lower_bound(begin(), end(), key, m_compare);
+    }
+    const_iterator upper_bound(const key_t &key) const noexcept { return std::upper_bound(begin(), end(), key, m_compare); }
+
+    const_iterator find(const key_t &key) const noexcept
+    {
+      const_iterator pos = lower_bound(key);
+      return pos != end() && !m_compare(key, *pos) ? pos : end();
+    }
+
+    bool contains(const key_t &key) const noexcept { return find(key) != end(); }
+    size_t count(const key_t &key) const noexcept { return contains(key) ? 1 : 0; }
+
+    //lays out a breadth first copy of the keys for faster lookups until the next change
+    void build_search_index() noexcept { m_index.build(m_keys.data(), m_keys.size()); }
+    bool has_search_index() const noexcept { return !m_index.empty(); }
+
+    const key_t* data() const noexcept { return m_keys.data(); }
+    const_iterator begin() const noexcept { return m_keys.begin(); }
+    const_iterator end() const noexcept { return m_keys.end(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_keys.empty(); }
+
+    size_t size() const noexcept { return m_keys.size(); }
+
+    void reserve(size_t new_cap) noexcept { m_keys.reserve(new_cap); }
+
+    void clear() noexcept
+    {
+      m_index.clear();
+      m_keys.clear();
+    }
+
+  private:
+    //neighbours in sorted order are equal when the first is not less than the second
+    auto equivalent() const noexcept { return [this](const key_t &lhs, const key_t &rhs) { return !m_compare(lhs, rhs); }; }
+
+    compare_t m_compare;
+    pod_vector<key_t, allocator_t> m_keys;
+    flat::eytzinger_index<key_t, compare_t, allocator_t> m_index;
+  };
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+
+namespace small_tl
+{
+  //growth policies decide the capacity pod_vector asks its allocator for
+  //grow is used when an insertion outgrows the block, reserve rounds an explicit request
+  //both return at least required
+
+  //doubles, reserve rounds up to a multiple of 32 elements
+  struct pod_growth_double
+  {
+    static size_t grow(size_t capacity, size_t required) noexcept { return std::max<size_t>({ capacity * 2, required, 32 }); }
+    static size_t reserve(size_t required) noexcept { return (required + 31) & ~size_t(31); }
+  };
+
+  //grows by half, less slack than doubling for more reallocations, which in place growth often makes cheap
+  struct pod_growth_geometric
+  {
+    static size_t grow(size_t capacity, size_t required) noexcept { return std::max<size_t>({ capacity + capacity / 2, required, 32 }); }
+    static size_t reserve(size_t required) noexcept { return (required + 31) & ~size_t(31); }
+  };
+
+  //grows by step elements at a time, for vectors whose final size is known to within a step
+  template<size_t step>
+  struct pod_growth_fixed
+  {
+    static_assert(step > 0, "pod_growth_fixed requires a step");
+    static size_t grow(size_t capacity, size_t required) noexcept { return reserve(std::max(capacity + step, required)); }
+    static size_t reserve(size_t required) noexcept { return (required + step - 1) / step * step; }
+  };
+
+  //allocates exactly what is asked for, every push_back past the capacity reallocates
+  struct pod_growth_exact
+  {
+    static size_t grow(size_t, size_t required) noexcept { return required; }
+    static size_t reserve(size_t required) noexcept { return required; }
+  };
+}
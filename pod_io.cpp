@@ -0,0 +1,139 @@
+#include "pod_io.h"
+#include <istream>
+#include <ostream>
+#include <algorithm>
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <climits>
+#endif
+
+namespace small_tl
+{
+  pod_header make_pod_header(size_t element_size, size_t count) noexcept
+  {
+    pod_header header;
+    header.magic = pod_header::magic_value;
+    header.version = pod_header::current_version;
+    header.endian = pod_header::endian_tag;
+    header.element_size = (uint32_t)element_size;
+    header.reserved = 0;
+    header.count = count;
+    return header;
+  }
+
+  bool is_compatible(const pod_header &header, size_t element_size) noexcept
+  {
+    return header.magic == pod_header::magic_value
+      && header.version == pod_header::current_version
+      && header.endian == pod_header::endian_tag
+      && header.element_size == element_size;
+  }
+
+#if !defined(_WIN32)
+  //writev may stop short at any byte, so the vectors are advanced past what was written and the call repeated
+  static bool write_all(int fd, iovec *vectors, int vector_count) noexcept
+  {
+    while (vector_count > 0)
+    {
+      ssize_t written = writev(fd, vectors, std::min(vector_count, IOV_MAX));
+      if (written < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+
+      size_t remaining = (size_t)written;
+      while (vector_count > 0 && remaining >= vectors->iov_len)
+      {
+        remaining -= vectors->iov_len;
+        ++vectors;
+        --vector_count;
+      }
+      if (vector_count > 0)
+      {
+        vectors->iov_base = (char *)vectors->iov_base + remaining;
+        vectors->iov_len -= remaining;
+      }
+    }
+    return true;
+  }
+
+  bool write_pod_range(int fd, const void *data, size_t element_size, size_t count) noexcept
+  {
+    pod_header header = make_pod_header(element_size, count);
+    iovec vectors[2];
+    vectors[0].iov_base = &header;
+    vectors[0].iov_len = sizeof(header);
+    vectors[1].iov_base = const_cast<void *>(data);
+    vectors[1].iov_len = element_size * count;
+    return write_all(fd, vectors, count == 0 ? 1 : 2);
+  }
+
+  bool read_pod_bytes(int fd, void *dst, size_t bytes) noexcept
+  {
+    char *cursor = (char *)dst;
+    while (bytes > 0)
+    {
+      ssize_t got = read(fd, cursor, bytes);
+      if (got < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      //the file ended before the count in its header
+      if (got == 0)
+        return false;
+      cursor += got;
+      bytes -= (size_t)got;
+    }
+    return true;
+  }
+
+  bool read_pod_header(int fd, size_t element_size, size_t &count) noexcept
+  {
+    pod_header header;
+    if (!read_pod_bytes(fd, &header, sizeof(header)) || !is_compatible(header, element_size) || header.count != (size_t)header.count)
+      return false;
+
+    //a regular file must still hold every element the header claims, pipes and sockets are only found short when they end
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode))
+    {
+      off_t position = lseek(fd, 0, SEEK_CUR);
+      if (position < 0 || position > file_stat.st_size || header.count > (uint64_t)(file_stat.st_size - position) / element_size)
+        return false;
+    }
+    count = (size_t)header.count;
+    return true;
+  }
+#endif
+
+  bool write_pod_range(std::ostream &stream, const void *data, size_t element_size, size_t count)
+  {
+    pod_header header = make_pod_header(element_size, count);
+    stream.write((const char *)&header, sizeof(header));
+    stream.write((const char *)data, (std::streamsize)(element_size * count));
+    return stream.good();
+  }
+
+  bool read_pod_bytes(std::istream &stream, void *dst, size_t bytes)
+  {
+    stream.read((char *)dst, (std::streamsize)bytes);
+    return stream.good() && (size_t)stream.gcount() == bytes;
+  }
+
+  bool read_pod_header(std::istream &stream, size_t element_size, size_t &count)
+  {
+    pod_header header;
+    if (!read_pod_bytes(stream, &header, sizeof(header)) || !is_compatible(header, element_size) || header.count != (size_t)header.count)
+      return false;
+    count = (size_t)header.count;
+    return true;
+  }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <iosfwd>
+#include <cstddef>
+#include <cstdint>
+
+namespace small_tl
+{
+  //the header written ahead of a serialised pod range, the elements follow it as raw bytes
+  //files are only read back on a machine with the same byte order and element size, there is no conversion
+  struct pod_header
+  {
+    static constexpr uint32_t magic_value = 0x444F5053; //"SPOD" in little endian
+    static constexpr uint16_t current_version = 1;
+    static constexpr uint16_t endian_tag = 0x0102; //reads back as 0x0201 on a machine of the other byte order
+
+    uint32_t magic;
+    uint16_t version;
+    uint16_t endian;
+    uint32_t element_size;
+    uint32_t reserved;
+    uint64_t count;
+  };
+  static_assert(sizeof(pod_header) == 24, "pod_header must have no padding");
+
+  pod_header make_pod_header(size_t element_size, size_t count) noexcept;
+
+  //false when the header is from another version, byte order or element type
+  bool is_compatible(const pod_header &header, size_t element_size) noexcept;
+
+#if !defined(_WIN32)
+  //the header and the elements leave in one writev, partial writes are resumed
+  bool write_pod_range(int fd, const void *data, size_t element_size, size_t count) noexcept;
+  //false for a count that does not fit in size_t, or when fd is a regular file with fewer bytes left than the count needs
+  bool read_pod_header(int fd, size_t element_size, size_t &count) noexcept;
+  //reads exactly bytes into dst, the caller points dst at its own storage so nothing is staged
+  bool read_pod_bytes(int fd, void *dst, size_t bytes) noexcept;
+#endif
+
+  //the same layout through a stream, one bulk write or read for the elements
+  bool write_pod_range(std::ostream &stream, const void *data, size_t element_size, size_t count);
+  bool read_pod_header(std::istream &stream, size_t element_size, size_t &count);
+  bool read_pod_bytes(std::istream &stream, void *dst, size_t bytes);
+}
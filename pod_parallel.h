@@ -0,0 +1,149 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <cassert>
+#include <cstring>
+#include "pod_allocator.h"
+#include "threading/worker_thread_pool.h"
+
+namespace small_tl
+{
+  //data parallel algorithms over contiguous pod ranges such as a pod_vector's begin() and end()
+  //ranges are split into chunks that run on a worker_thread_pool with the calling thread joining in
+  namespace parallel
+  {
+    //large enough to amortise scheduling, small enough to stay in l2 while it is worked on
+    static constexpr size_t target_chunk_bytes = 64 * 1024;
+    //chunks start on cache line boundaries relative to the range so neighbouring chunks do not write the same line
+    static constexpr size_t cache_line_bytes = 64;
+
+    //elements per chunk, at least a cache line and small enough to give every thread a few chunks to balance over
+    template<class pod_t>
+    size_t chunk_size(size_t count, size_t thread_count) noexcept
+    {
+      size_t line_elements = std::max<size_t>(1, cache_line_bytes / sizeof(pod_t));
+      size_t size = std::max<size_t>(1, target_chunk_bytes / sizeof(pod_t));
+      size_t balanced = count / ((thread_count + 1) * 4);
+      size = std::min(size, std::max(balanced, line_elements));
+      return (size + line_elements - 1) / line_elements * line_elements;
+    }
+
+    inline size_t chunk_count(size_t count, size_t chunk_size) noexcept
+    {
+      return (count + chunk_size - 1) / chunk_size;
+    }
+  }
+
+  //calls function on every element
+  template<class pod_t, class function_t>
+  void parallel_for_each(threading::worker_thread_pool &pool, pod_t *first, pod_t *last, function_t function)
+  {
+    size_t count = last - first;
+    size_t chunk_size = parallel::chunk_size<pod_t>(count, pool.thread_count());
+    pool.run_parallel(parallel::chunk_count(count, chunk_size), [&](size_t chunk)
+    {
+      pod_t *chunk_first = first + chunk * chunk_size;
+      std::for_each(chunk_first, std::min(chunk_first + chunk_size, last), function);
+    });
+  }
+
+  //writes function(*i) to the matching position in d_first, which may be first
+  template<class src_t, class dst_t, class function_t>
+  dst_t *parallel_transform(threading::worker_thread_pool &pool, const src_t *first, const src_t *last, dst_t *d_first, function_t function)
+  {
+    size_t count = last - first;
+    size_t chunk_size = parallel::chunk_size<dst_t>(count, pool.thread_count());
+    pool.run_parallel(parallel::chunk_count(count, chunk_size), [&](size_t chunk)
+    {
+      size_t offset = chunk * chunk_size;
+      size_t chunk_count = std::min(chunk_size, count - offset);
+      std::transform(first + offset, first + offset + chunk_count, d_first + offset, function);
+    });
+    return d_first + count;
+  }
+
+  //folds the range with op, which must be associative, chunk results are combined in order so op need not be commutative
+  template<class pod_t, class value_t, class op_t = std::plus<value_t>>
+  value_t parallel_reduce(threading::worker_thread_pool &pool, const pod_t *first, const pod_t *last, value_t init, op_t op = op_t())
+  {
+    size_t count = last - first;
+    if (count == 0)
+      return init;
+
+    size_t chunk_size = parallel::chunk_size<pod_t>(count, pool.thread_count());
+    size_t chunk_count = parallel::chunk_count(count, chunk_size);
+    std::vector<value_t> partials(chunk_count);
+    pool.run_parallel(chunk_count, [&](size_t chunk)
+    {
+      const pod_t *chunk_first = first + chunk * chunk_size;
+      const pod_t *chunk_last = std::min(chunk_first + chunk_size, last);
+      value_t partial = *chunk_first;
+      for (const pod_t *element = chunk_first + 1; element != chunk_last; ++element)
+        partial = op(partial, *element);
+      partials[chunk] = partial;
+    });
+
+    for (value_t &partial : partials)
+      init = op(init, partial);
+    return init;
+  }
+
+  //sorts runs on every thread, then merges pairs of runs in parallel rounds through a scratch buffer
+  template<class pod_t, class compare_t = std::less<pod_t>>
+  void parallel_sort(threading::worker_thread_pool &pool, pod_t *first, pod_t *last, compare_t compare = compare_t())
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "parallel_sort requires a trivial type");
+    size_t count = last - first;
+    size_t run_count = std::min(pool.thread_count() + 1, parallel::chunk_count(count, parallel::target_chunk_bytes / sizeof(pod_t)));
+    if (run_count <= 1)
+    {
+      std::sort(first, last, compare);
+      return;
+    }
+
+    size_t run_size = parallel::chunk_count(count, run_count);
+    pool.run_parallel(run_count, [&](size_t run)
+    {
+      pod_t *run_first = first + std::min(count, run * run_size);
+      std::sort(run_first, first + std::min(count, (run + 1) * run_size), compare);
+    });
+
+    pod_malloc_allocator allocator;
+    pod_t *scratch = (pod_t *)allocator.allocate(count * sizeof(pod_t));
+    if (scratch == nullptr)
+    {
+      //no scratch buffer, merge the same pairs in place, slower but it still runs the rounds in parallel
+      for (size_t width = run_size; width < count; width *= 2)
+      {
+        pool.run_parallel(parallel::chunk_count(count, width * 2), [&](size_t pair)
+        {
+          size_t pair_first = pair * width * 2;
+          size_t middle = std::min(count, pair_first + width);
+          std::inplace_merge(first + pair_first, first + middle, first + std::min(count, pair_first + width * 2), compare);
+        });
+      }
+      return;
+    }
+
+    pod_t *src = first;
+    pod_t *dst = scratch;
+    for (size_t width = run_size; width < count; width *= 2)
+    {
+      size_t pair_count = parallel::chunk_count(count, width * 2);
+      pool.run_parallel(pair_count, [&](size_t pair)
+      {
+        size_t pair_first = pair * width * 2;
+        size_t middle = std::min(count, pair_first + width);
+        size_t pair_last = std::min(count, pair_first + width * 2);
+        std::merge(src + pair_first, src + middle, src + middle, src + pair_last, dst + pair_first, compare);
+      });
+      std::swap(src, dst);
+    }
+
+    if (src != first)
+      memcpy(first, src, count * sizeof(pod_t));
+    allocator.deallocate(scratch, count * sizeof(pod_t));
+  }
+}
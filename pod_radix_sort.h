@@ -0,0 +1,174 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "pod_vector.h"
+#include "threading/worker_thread_pool.h"
+
+namespace small_tl
+{
+  namespace radix
+  {
+    //below this a comparison sort beats clearing and walking the histograms
+    static constexpr size_t small_sort_count = 256;
+    //ranges smaller than this are not worth handing to the pool for histogramming
+    static constexpr size_t parallel_histogram_count = 1 << 16;
+
+    //maps a key onto an unsigned integer with the same ordering
+    template<class key_t>
+    auto ordered_bits(key_t key) noexcept
+    {
+      static_assert(std::is_arithmetic<key_t>::value, "radix keys must be integral or floating point");
+      typedef typename std::conditional<sizeof(key_t) == 1, uint8_t,
+        typename std::conditional<sizeof(key_t) == 2, uint16_t,
+        typename std::conditional<sizeof(key_t) == 4, uint32_t, uint64_t>::type>::type>::type bits_t;
+      static_assert(sizeof(bits_t) == sizeof(key_t), "unsupported radix key size");
+      const bits_t sign_bit = bits_t(1) << (sizeof(bits_t) * 8 - 1);
+
+      bits_t bits;
+      memcpy(&bits, &key, sizeof(bits_t));
+      if constexpr (std::is_floating_point<key_t>::value)
+        //negative floats order backwards, so flip all of their bits, positive floats just need to sort above them
+        return (bits_t)((bits & sign_bit) ? ~bits : bits | sign_bit);
+      else if constexpr (std::is_signed<key_t>::value)
+        return (bits_t)(bits ^ sign_bit);
+      else
+        return bits;
+    }
+
+    template<class key_function_t, class pod_t>
+    using key_t = typename std::decay<decltype(std::declval<key_function_t>()(std::declval<const pod_t &>()))>::type;
+
+    struct identity_key
+    {
+      template<class pod_t>
+      pod_t operator()(const pod_t &value) const noexcept { return value; }
+    };
+
+    template<size_t passes>
+    struct histograms
+    {
+      size_t counts[passes][256];
+    };
+
+    template<size_t passes, class pod_t, class key_function_t>
+    void count_digits(const pod_t *first, const pod_t *last, key_function_t &key, histograms<passes> &result) noexcept
+    {
+      memset(&result, 0, sizeof(result));
+      for (const pod_t *element = first; element != last; ++element)
+      {
+        auto bits = ordered_bits(key(*element));
+        for (size_t pass = 0; pass < passes; ++pass)
+          ++result.counts[pass][(bits >> (pass * 8)) & 0xFF];
+      }
+    }
+
+    template<class pod_t, class key_function_t>
+    void comparison_sort(pod_t *data, size_t count, key_function_t &key)
+    {
+      std::stable_sort(data, data + count, [&key](const pod_t &lhs, const pod_t &rhs) { return ordered_bits(key(lhs)) < ordered_bits(key(rhs)); });
+    }
+
+    //stable lsd sort over 8 bit digits, pool is optional and only used to build the histograms
+    template<class pod_t, class allocator_t, class growth_t, class key_function_t>
+    void sort(pod_vector<pod_t, allocator_t, growth_t> &vector, key_function_t key, threading::worker_thread_pool *pool)
+    {
+      static constexpr size_t passes = sizeof(key_t<key_function_t, pod_t>);
+      pod_t *data = vector.data();
+      size_t count = vector.size();
+      if (count < small_sort_count)
+      {
+        comparison_sort(data, count, key);
+        return;
+      }
+
+      //the scratch buffer comes from the vector's own storage policy, without it the comparison sort still gives the same order
+      allocator_t allocator = vector.get_allocator();
+      pod_t *scratch = (pod_t *)allocator.allocate(count * sizeof(pod_t));
+      if (scratch == nullptr)
+      {
+        comparison_sort(data, count, key);
+        return;
+      }
+
+      //every digit is counted in one read of the data
+      histograms<passes> totals;
+      if (pool != nullptr && count >= parallel_histogram_count)
+      {
+        size_t chunk_count = pool->thread_count() + 1;
+        size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+        std::vector<histograms<passes>> partials(chunk_count);
+        pool->run_parallel(chunk_count, [&](size_t chunk)
+        {
+          const pod_t *chunk_first = data + std::min(count, chunk * chunk_size);
+          const pod_t *chunk_last = data + std::min(count, (chunk + 1) * chunk_size);
+          count_digits(chunk_first, chunk_last, key, partials[chunk]);
+        });
+        totals = partials[0];
+        for (size_t chunk = 1; chunk < chunk_count; ++chunk)
+          for (size_t pass = 0; pass < passes; ++pass)
+            for (size_t digit = 0; digit < 256; ++digit)
+              totals.counts[pass][digit] += partials[chunk].counts[pass][digit];
+      }
+      else
+        count_digits(data, data + count, key, totals);
+
+      pod_t *src = data;
+      pod_t *dst = scratch;
+      for (size_t pass = 0; pass < passes; ++pass)
+      {
+        size_t *counts = totals.counts[pass];
+        size_t shift = pass * 8;
+
+        //a pass where every key has the same digit would only copy
+        if (counts[(ordered_bits(key(src[0])) >> shift) & 0xFF] == count)
+          continue;
+
+        size_t offsets[256];
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; ++digit)
+        {
+          offsets[digit] = offset;
+          offset += counts[digit];
+        }
+
+        for (const pod_t *element = src; element != src + count; ++element)
+          memcpy(dst + offsets[(ordered_bits(key(*element)) >> shift) & 0xFF]++, element, sizeof(pod_t));
+        std::swap(src, dst);
+      }
+
+      if (src != data)
+        memcpy(data, src, count * sizeof(pod_t));
+      allocator.deallocate(scratch, count * sizeof(pod_t));
+    }
+  }
+
+  //sorts a vector of integers or floating point values
+  template<class pod_t, class allocator_t, class growth_t>
+  void radix_sort(pod_vector<pod_t, allocator_t, growth_t> &vector)
+  {
+    radix::sort(vector, radix::identity_key(), nullptr);
+  }
+
+  //sorts a vector of records by the integral or floating point value key returns, equal keys keep their order
+  template<class pod_t, class allocator_t, class growth_t, class key_function_t>
+  void radix_sort(pod_vector<pod_t, allocator_t, growth_t> &vector, key_function_t key)
+  {
+    radix::sort(vector, key, nullptr);
+  }
+
+  //as radix_sort, counting digits across the pool
+  template<class pod_t, class allocator_t, class growth_t>
+  void radix_sort(threading::worker_thread_pool &pool, pod_vector<pod_t, allocator_t, growth_t> &vector)
+  {
+    radix::sort(vector, radix::identity_key(), &pool);
+  }
+
+  template<class pod_t, class allocator_t, class growth_t, class key_function_t>
+  void radix_sort(threading::worker_thread_pool &pool, pod_vector<pod_t, allocator_t, growth_t> &vector, key_function_t key)
+  {
+    radix::sort(vector, key, &pool);
+  }
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "pod_allocator.h"
+
+namespace small_tl
+{
+  //a contiguous double ended queue with a power of two capacity, indices wrap with a mask
+  //bulk enqueue and dequeue copy at most two spans, full buffers double and only move the wrapped part
+  //the growing members return false if the allocator can not provide the block, the buffer is then unchanged
+  template<class pod_t, class allocator_t = pod_malloc_allocator>
+  class pod_ring_buffer
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "pod_ring_buffer requires a trivial type");
+  public:
+
+    typedef pod_t value_type;
+
+    pod_ring_buffer() noexcept : pod_ring_buffer(allocator_t()) {}
+    explicit pod_ring_buffer(const allocator_t &allocator) noexcept : m_allocator(allocator), m_ptr(nullptr), m_capacity(0), m_head(0), m_size(0) {}
+
+    pod_ring_buffer(const pod_ring_buffer &) = delete;
+    pod_ring_buffer &operator=(const pod_ring_buffer &) = delete;
+
+    pod_ring_buffer(pod_ring_buffer &&other) noexcept : m_allocator(other.m_allocator), m_ptr(other.m_ptr), m_capacity(other.m_capacity), m_head(other.m_head), m_size(other.m_size)
+    {
+      other.m_ptr = nullptr;
+      other.m_capacity = other.m_head = other.m_size = 0;
+    }
+    pod_ring_buffer &operator=(pod_ring_buffer &&other) noexcept
+    {
+      pod_ring_buffer moved(std::move(other));
+      swap(moved);
+      return *this;
+    }
+
+    ~pod_ring_buffer() { m_allocator.deallocate(m_ptr, m_capacity * sizeof(pod_t)); }
+
+    //pos counts from the front
+    pod_t& at(size_t pos) noexcept { return m_ptr[(m_head + pos) & mask()]; }
+    const pod_t& at(size_t pos) const noexcept { return m_ptr[(m_head + pos) & mask()]; }
+
+    pod_t& operator [](size_t pos) noexcept { return at(pos); }
+    const pod_t& operator [](size_t pos) const noexcept { return at(pos); }
+
+    pod_t& front() noexcept { return at(0); }
+    const pod_t& front() const noexcept { return at(0); }
+
+    pod_t& back() noexcept { return at(m_size - 1); }
+    const pod_t& back() const noexcept { return at(m_size - 1); }
+
+    bool empty() const noexcept { return m_size == 0; }
+    bool full() const noexcept { return m_size == m_capacity; }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t capacity() const noexcept { return m_capacity; }
+
+    //rounds up to a power of two
+    bool reserve(size_t new_cap) noexcept
+    {
+      if (new_cap <= m_capacity)return true;
+      size_t rounded = std::max<size_t>(m_capacity, 16);
+      while (rounded < new_cap)
+      {
+        if (rounded > std::numeric_limits<size_t>::max() / sizeof(pod_t) / 2)
+          return false;
+        rounded *= 2;
+      }
+      return grow(rounded);
+    }
+
+    void clear() noexcept { m_head = m_size = 0; }
+
+    bool push_back(const pod_t &value) noexcept
+    {
+      //value may reference an element that growth is about to move
+      alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+      memcpy(copy, &value, sizeof(pod_t));
+      if (full() && !reserve(m_capacity + 1))
+        return false;
+      memcpy(m_ptr + ((m_head + m_size) & mask()), copy, sizeof(pod_t));
+      ++m_size;
+      return true;
+    }
+
+    bool push_front(const pod_t &value) noexcept
+    {
+      alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+      memcpy(copy, &value, sizeof(pod_t));
+      if (full() && !reserve(m_capacity + 1))
+        return false;
+      m_head = (m_head - 1) & mask();
+      memcpy(m_ptr + m_head, copy, sizeof(pod_t));
+      ++m_size;
+      return true;
+    }
+
+    void pop_front() noexcept
+    {
+      m_head = (m_head + 1) & mask();
+      --m_size;
+    }
+
+    void pop_back() noexcept
+    {
+      --m_size;
+    }
+
+    //appends count elements from src
+    bool enqueue(const pod_t *src, size_t count) noexcept
+    {
+      if (count == 0)return true;
+      if (count > std::numeric_limits<size_t>::max() - m_size || !reserve(m_size + count))
+        return false;
+      size_t tail = (m_head + m_size) & mask();
+      size_t first_span = std::min(count, m_capacity - tail);
+      memcpy(m_ptr + tail, src, first_span * sizeof(pod_t));
+      memcpy(m_ptr, src + first_span, (count - first_span) * sizeof(pod_t));
+      m_size += count;
+      return true;
+    }
+
+    //removes up to count elements from the front into dst, returns how many were removed
+    size_t dequeue(pod_t *dst, size_t count) noexcept
+    {
+      count = peek(dst, count);
+      m_head = (m_head + count) & mask();
+      m_size -= count;
+      return count;
+    }
+
+    //copies up to count elements from the front into dst without removing them
+    size_t peek(pod_t *dst, size_t count) const noexcept
+    {
+      count = std::min(count, m_size);
+      if (count == 0)return 0;
+      size_t first_span = std::min(count, m_capacity - m_head);
+      memcpy(dst, m_ptr + m_head, first_span * sizeof(pod_t));
+      memcpy(dst + first_span, m_ptr, (count - first_span) * sizeof(pod_t));
+      return count;
+    }
+
+    void swap(pod_ring_buffer &other) noexcept
+    {
+      std::swap(m_allocator, other.m_allocator);
+      std::swap(m_ptr, other.m_ptr);
+      std::swap(m_capacity, other.m_capacity);
+      std::swap(m_head, other.m_head);
+      std::swap(m_size, other.m_size);
+    }
+
+  private:
+    size_t mask() const noexcept { return m_capacity - 1; }
+
+    //the block is grown in place where possible, then only the part that wrapped past the old end is moved up to follow it
+    //a failed reallocate leaves the old block in place
+    bool grow(size_t new_cap) noexcept
+    {
+      size_t bytes_copied = 0;
+      pod_t *new_ptr = (pod_t *)m_allocator.reallocate(m_ptr, m_capacity * sizeof(pod_t), new_cap * sizeof(pod_t), bytes_copied);
+      if (new_ptr == nullptr)
+        return false;
+      m_ptr = new_ptr;
+      size_t wrapped = m_head + m_size > m_capacity ? m_head + m_size - m_capacity : 0;
+      memcpy(m_ptr + m_capacity, m_ptr, wrapped * sizeof(pod_t));
+      m_capacity = new_cap;
+      return true;
+    }
+
+    allocator_t m_allocator;
+    pod_t *m_ptr;
+    size_t m_capacity;
+    size_t m_head;
+    size_t m_size;
+  };
+}
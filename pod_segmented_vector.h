@@ -0,0 +1,275 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "cpu_features.h"
+#include "pod_allocator.h"
+#include "pod_span.h"
+
+namespace small_tl
+{
+  //a vector stored in segments that double in size, growth allocates the next segment and never copies or moves an element
+  //pointers to elements stay valid until they are popped, segments() walks the contents as contiguous spans for bulk work
+  //the growing members return false if the allocator can not provide a segment, the vector is then unchanged
+  template<class pod_t, size_t first_segment_bytes = 4096, class allocator_t = pod_malloc_allocator>
+  class pod_segmented_vector
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "pod_segmented_vector requires a trivial type");
+
+    static constexpr size_t first_segment_shift()
+    {
+      size_t shift = 0;
+      while (sizeof(pod_t) << (shift + 1) <= first_segment_bytes)
+        ++shift;
+      return shift;
+    }
+
+  public:
+    //elements in the first segment, a power of two so an index splits into segment and offset with a shift
+    static constexpr size_t segment_shift = first_segment_shift();
+    static constexpr size_t first_segment_elements = size_t(1) << segment_shift;
+    //enough segments to address every byte
+    static constexpr size_t max_segments = 64 - segment_shift;
+
+    typedef pod_t value_type;
+
+    template<class owner_t, class element_t>
+    class basic_iterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef pod_t value_type;
+      typedef ptrdiff_t difference_type;
+      typedef element_t& reference;
+      typedef element_t* pointer;
+
+      basic_iterator() noexcept : m_owner(nullptr), m_index(0) {}
+      basic_iterator(owner_t *owner, size_t index) noexcept : m_owner(owner), m_index(index) {}
+
+      reference operator*() const noexcept { return (*m_owner)[m_index]; }
+      pointer operator->() const noexcept { return &(*m_owner)[m_index]; }
+      reference operator[](difference_type offset) const noexcept { return (*m_owner)[m_index + offset]; }
+
+      basic_iterator &operator++() noexcept { ++m_index; return *this; }
+      basic_iterator &operator--() noexcept { --m_index; return *this; }
+      basic_iterator operator++(int) noexcept { basic_iterator previous = *this; ++m_index; return previous; }
+      basic_iterator operator--(int) noexcept { basic_iterator previous = *this; --m_index; return previous; }
+      basic_iterator &operator+=(difference_type offset) noexcept { m_index += offset; return *this; }
+      basic_iterator &operator-=(difference_type offset) noexcept { m_index -= offset; return *this; }
+      basic_iterator operator+(difference_type offset) const noexcept { return basic_iterator(m_owner, m_index + offset); }
+      basic_iterator operator-(difference_type offset) const noexcept { return basic_iterator(m_owner, m_index - offset); }
+      difference_type operator-(const basic_iterator &other) const noexcept { return (difference_type)m_index - (difference_type)other.m_index; }
+
+      bool operator==(const basic_iterator &other) const noexcept { return m_index == other.m_index; }
+      bool operator!=(const basic_iterator &other) const noexcept { return m_index != other.m_index; }
+      bool operator<(const basic_iterator &other) const noexcept { return m_index < other.m_index; }
+      bool operator>(const basic_iterator &other) const noexcept { return m_index > other.m_index; }
+      bool operator<=(const basic_iterator &other) const noexcept { return m_index <= other.m_index; }
+      bool operator>=(const basic_iterator &other) const noexcept { return m_index >= other.m_index; }
+
+    private:
+      owner_t *m_owner;
+      size_t m_index;
+    };
+
+    typedef basic_iterator<pod_segmented_vector, pod_t> iterator;
+    typedef basic_iterator<const pod_segmented_vector, const pod_t> const_iterator;
+
+    //steps over the used part of each segment in order
+    template<class owner_t, class element_t>
+    class basic_segment_iterator
+    {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef pod_span<element_t> value_type;
+      typedef ptrdiff_t difference_type;
+      typedef pod_span<element_t> reference;
+      typedef void pointer;
+
+      basic_segment_iterator(owner_t *owner, size_t segment) noexcept : m_owner(owner), m_segment(segment) {}
+
+      reference operator*() const noexcept { return m_owner->segment(m_segment); }
+
+      basic_segment_iterator &operator++() noexcept { ++m_segment; return *this; }
+      basic_segment_iterator operator++(int) noexcept { basic_segment_iterator previous = *this; ++m_segment; return previous; }
+
+      bool operator==(const basic_segment_iterator &other) const noexcept { return m_segment == other.m_segment; }
+      bool operator!=(const basic_segment_iterator &other) const noexcept { return m_segment != other.m_segment; }
+
+    private:
+      owner_t *m_owner;
+      size_t m_segment;
+    };
+
+    template<class segment_iterator_t>
+    struct segment_range
+    {
+      segment_iterator_t first;
+      segment_iterator_t last;
+      segment_iterator_t begin() const noexcept { return first; }
+      segment_iterator_t end() const noexcept { return last; }
+    };
+
+    typedef basic_segment_iterator<pod_segmented_vector, pod_t> segment_iterator;
+    typedef basic_segment_iterator<const pod_segmented_vector, const pod_t> const_segment_iterator;
+
+    pod_segmented_vector() noexcept : pod_segmented_vector(allocator_t()) {}
+    explicit pod_segmented_vector(const allocator_t &allocator) noexcept : m_allocator(allocator), m_segments(), m_segment_count(0), m_size(0) {}
+
+    pod_segmented_vector(const pod_segmented_vector &) = delete;
+    pod_segmented_vector &operator=(const pod_segmented_vector &) = delete;
+
+    pod_segmented_vector(pod_segmented_vector &&other) noexcept : pod_segmented_vector(other.m_allocator) { swap(other); }
+    pod_segmented_vector &operator=(pod_segmented_vector &&other) noexcept
+    {
+      pod_segmented_vector moved(std::move(other));
+      swap(moved);
+      return *this;
+    }
+
+    ~pod_segmented_vector() { release_segments(0); }
+
+    pod_t& at(size_t pos) noexcept
+    {
+      size_t segment = segment_of(pos);
+      return m_segments[segment][pos - segment_start(segment)];
+    }
+    const pod_t& at(size_t pos) const noexcept
+    {
+      size_t segment = segment_of(pos);
+      return m_segments[segment][pos - segment_start(segment)];
+    }
+
+    pod_t& operator [](size_t pos) noexcept { return at(pos); }
+    const pod_t& operator [](size_t pos) const noexcept { return at(pos); }
+
+    pod_t& front() noexcept { return m_segments[0][0]; }
+    const pod_t& front() const noexcept { return m_segments[0][0]; }
+
+    pod_t& back() noexcept { return at(m_size - 1); }
+    const pod_t& back() const noexcept { return at(m_size - 1); }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, m_size); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, m_size); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    //the used part of a segment, every segment before the last in use is full
+    pod_span<pod_t> segment(size_t segment) noexcept { return pod_span<pod_t>(m_segments[segment], segment_used(segment)); }
+    pod_span<const pod_t> segment(size_t segment) const noexcept { return pod_span<const pod_t>(m_segments[segment], segment_used(segment)); }
+
+    //the segments holding elements, for running kernels over contiguous memory
+    segment_range<segment_iterator> segments() noexcept { return { segment_iterator(this, 0), segment_iterator(this, used_segments()) }; }
+    segment_range<const_segment_iterator> segments() const noexcept { return { const_segment_iterator(this, 0), const_segment_iterator(this, used_segments()) }; }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t capacity() const noexcept { return segment_start(m_segment_count); }
+
+    bool reserve(size_t new_cap) noexcept
+    {
+      size_t segment_count = m_segment_count;
+      while (capacity() < new_cap)
+      {
+        if (!add_segment())
+        {
+          release_segments(segment_count);
+          return false;
+        }
+      }
+      return true;
+    }
+
+    //frees the segments past the one holding the last element
+    void shrink_to_fit() noexcept { release_segments(used_segments()); }
+
+    void clear() noexcept { m_size = 0; }
+
+    bool push_back(const pod_t& value) noexcept
+    {
+      if (m_size == capacity() && !add_segment())
+        return false;
+      memcpy(&at(m_size), &value, sizeof(pod_t));
+      ++m_size;
+      return true;
+    }
+
+    //copies count elements in with one memcpy per segment touched
+    bool append(const pod_t *src, size_t count) noexcept
+    {
+      if (count > std::numeric_limits<size_t>::max() - m_size || !reserve(m_size + count))
+        return false;
+      while (count > 0)
+      {
+        size_t segment = segment_of(m_size);
+        size_t offset = m_size - segment_start(segment);
+        size_t span = std::min(count, segment_elements(segment) - offset);
+        memcpy(m_segments[segment] + offset, src, span * sizeof(pod_t));
+        m_size += span;
+        src += span;
+        count -= span;
+      }
+      return true;
+    }
+
+    void pop_back() noexcept
+    {
+      --m_size;
+    }
+
+    void swap(pod_segmented_vector &other) noexcept
+    {
+      std::swap(m_allocator, other.m_allocator);
+      std::swap(m_segments, other.m_segments);
+      std::swap(m_segment_count, other.m_segment_count);
+      std::swap(m_size, other.m_size);
+    }
+
+  private:
+    static size_t segment_elements(size_t segment) noexcept { return first_segment_elements << segment; }
+    //the index of a segment's first element, segment k starts after first_segment_elements * (2^k - 1) elements
+    static size_t segment_start(size_t segment) noexcept { return segment_elements(segment) - first_segment_elements; }
+    static size_t segment_of(size_t pos) noexcept { return highest_set_bit64((pos >> segment_shift) + 1); }
+
+    size_t used_segments() const noexcept { return m_size == 0 ? 0 : segment_of(m_size - 1) + 1; }
+
+    size_t segment_used(size_t segment) const noexcept
+    {
+      size_t start = segment_start(segment);
+      return std::min(segment_elements(segment), m_size - start);
+    }
+
+    bool add_segment() noexcept
+    {
+      if (m_segment_count == max_segments || segment_elements(m_segment_count) > std::numeric_limits<size_t>::max() / sizeof(pod_t))
+        return false;
+      pod_t *segment = (pod_t *)m_allocator.allocate(segment_elements(m_segment_count) * sizeof(pod_t));
+      if (segment == nullptr)
+        return false;
+      m_segments[m_segment_count++] = segment;
+      return true;
+    }
+
+    void release_segments(size_t keep) noexcept
+    {
+      while (m_segment_count > keep)
+      {
+        --m_segment_count;
+        m_allocator.deallocate(m_segments[m_segment_count], segment_elements(m_segment_count) * sizeof(pod_t));
+        m_segments[m_segment_count] = nullptr;
+      }
+    }
+
+    allocator_t m_allocator;
+    pod_t *m_segments[max_segments];
+    size_t m_segment_count;
+    size_t m_size;
+  };
+}
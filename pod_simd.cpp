@@ -0,0 +1,536 @@
+#include "pod_simd.h"
+#include "cpu_features.h"
+
+#if defined(SMALL_TL_X86)
+#include <immintrin.h>
+#endif
+
+namespace small_tl::simd
+{
+  //
+  //scalar
+  //
+
+  template<class value_t>
+  static void fill_scalar(value_t *dst, size_t count, value_t value) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = value;
+  }
+
+  template<class value_t>
+  static size_t find_scalar(const value_t *src, size_t count, value_t value) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+      if (src[i] == value)return i;
+    return count;
+  }
+
+  template<class value_t>
+  static size_t count_scalar(const value_t *src, size_t count, value_t value) noexcept
+  {
+    size_t matches = 0;
+    for (size_t i = 0; i < count; ++i)
+      matches += src[i] == value;
+    return matches;
+  }
+
+  static size_t mismatch_bytes_scalar(const uint8_t *lhs, const uint8_t *rhs, size_t byte_count) noexcept
+  {
+    for (size_t i = 0; i < byte_count; ++i)
+      if (lhs[i] != rhs[i])return i;
+    return byte_count;
+  }
+
+  static size_t mismatch_f32_scalar(const float *lhs, const float *rhs, size_t count) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+      if (!(lhs[i] == rhs[i]))return i;
+    return count;
+  }
+
+  template<class value_t>
+  static value_t min_scalar(const value_t *src, size_t count) noexcept
+  {
+    value_t result = src[0];
+    for (size_t i = 1; i < count; ++i)
+      result = src[i] < result ? src[i] : result;
+    return result;
+  }
+
+  template<class value_t>
+  static value_t max_scalar(const value_t *src, size_t count) noexcept
+  {
+    value_t result = src[0];
+    for (size_t i = 1; i < count; ++i)
+      result = result < src[i] ? src[i] : result;
+    return result;
+  }
+
+#if defined(SMALL_TL_X86)
+  //lane counters are flushed before they can overflow
+  static const size_t count_block = size_t(1) << 30;
+
+  //
+  //sse2
+  //
+
+  static void fill16_sse2(uint16_t *dst, size_t count, uint16_t value) noexcept
+  {
+    __m128i broadcast = _mm_set1_epi16((short)value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+      _mm_storeu_si128((__m128i *)(dst + i), broadcast);
+    fill_scalar(dst + i, count - i, value);
+  }
+
+  static void fill32_sse2(uint32_t *dst, size_t count, uint32_t value) noexcept
+  {
+    __m128i broadcast = _mm_set1_epi32((int)value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+      _mm_storeu_si128((__m128i *)(dst + i), broadcast);
+    fill_scalar(dst + i, count - i, value);
+  }
+
+  static void fill64_sse2(uint64_t *dst, size_t count, uint64_t value) noexcept
+  {
+    __m128i broadcast = _mm_set1_epi64x((long long)value);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2)
+      _mm_storeu_si128((__m128i *)(dst + i), broadcast);
+    fill_scalar(dst + i, count - i, value);
+  }
+
+  static size_t find_u32_sse2(const uint32_t *src, size_t count, uint32_t value) noexcept
+  {
+    __m128i needle = _mm_set1_epi32((int)value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128i equal = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(src + i)), needle);
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(equal));
+      if (mask != 0)return i + count_trailing_zeros(mask);
+    }
+    return i + find_scalar(src + i, count - i, value);
+  }
+
+  static size_t find_f32_sse2(const float *src, size_t count, float value) noexcept
+  {
+    __m128 needle = _mm_set1_ps(value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(src + i), needle));
+      if (mask != 0)return i + count_trailing_zeros(mask);
+    }
+    return i + find_scalar(src + i, count - i, value);
+  }
+
+  static size_t horizontal_sum_sse2(__m128i counters) noexcept
+  {
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, counters);
+    return (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  static size_t count_u32_sse2(const uint32_t *src, size_t count, uint32_t value) noexcept
+  {
+    __m128i needle = _mm_set1_epi32((int)value);
+    size_t matches = 0;
+    size_t i = 0;
+    while (i + 4 <= count)
+    {
+      //each match is -1, so subtracting the comparison counts it
+      __m128i counters = _mm_setzero_si128();
+      size_t block_end = std::min(count & ~size_t(3), i + count_block);
+      for (; i < block_end; i += 4)
+        counters = _mm_sub_epi32(counters, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(src + i)), needle));
+      matches += horizontal_sum_sse2(counters);
+    }
+    return matches + count_scalar(src + i, count - i, value);
+  }
+
+  static size_t count_f32_sse2(const float *src, size_t count, float value) noexcept
+  {
+    __m128 needle = _mm_set1_ps(value);
+    size_t matches = 0;
+    size_t i = 0;
+    while (i + 4 <= count)
+    {
+      __m128i counters = _mm_setzero_si128();
+      size_t block_end = std::min(count & ~size_t(3), i + count_block);
+      for (; i < block_end; i += 4)
+        counters = _mm_sub_epi32(counters, _mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(src + i), needle)));
+      matches += horizontal_sum_sse2(counters);
+    }
+    return matches + count_scalar(src + i, count - i, value);
+  }
+
+  static size_t mismatch_bytes_sse2(const uint8_t *lhs, const uint8_t *rhs, size_t byte_count) noexcept
+  {
+    size_t i = 0;
+    for (; i + 16 <= byte_count; i += 16)
+    {
+      __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(lhs + i)), _mm_loadu_si128((const __m128i *)(rhs + i)));
+      uint32_t mask = (uint32_t)_mm_movemask_epi8(equal);
+      if (mask != 0xFFFF)return i + count_trailing_zeros(~mask);
+    }
+    return i + mismatch_bytes_scalar(lhs + i, rhs + i, byte_count - i);
+  }
+
+  static size_t mismatch_f32_sse2(const float *lhs, const float *rhs, size_t count) noexcept
+  {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+      uint32_t mask = (uint32_t)_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(lhs + i), _mm_loadu_ps(rhs + i)));
+      if (mask != 0xF)return i + count_trailing_zeros(~mask);
+    }
+    return i + mismatch_f32_scalar(lhs + i, rhs + i, count - i);
+  }
+
+  //sse2 has no 32 bit min or max, so select through a signed compare
+  static __m128i select_sse2(__m128i take_b, __m128i a, __m128i b) noexcept
+  {
+    return _mm_or_si128(_mm_and_si128(take_b, b), _mm_andnot_si128(take_b, a));
+  }
+
+  //unsigned values are biased into signed range so one kernel serves both
+  template<bool is_min, bool is_unsigned, class value_t>
+  static value_t min_max_i32_sse2(const value_t *src, size_t count) noexcept
+  {
+    if (count < 4)
+      return is_min ? min_scalar(src, count) : max_scalar(src, count);
+
+    const __m128i bias = _mm_set1_epi32(is_unsigned ? (int)0x80000000 : 0);
+    __m128i result = _mm_xor_si128(_mm_loadu_si128((const __m128i *)src), bias);
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4)
+    {
+      __m128i next = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src + i)), bias);
+      __m128i take_next = is_min ? _mm_cmpgt_epi32(result, next) : _mm_cmpgt_epi32(next, result);
+      result = select_sse2(take_next, result, next);
+    }
+
+    value_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, _mm_xor_si128(result, bias));
+    value_t reduced = is_min ? min_scalar(lanes, 4) : max_scalar(lanes, 4);
+    if (i < count)
+    {
+      value_t tail = is_min ? min_scalar(src + i, count - i) : max_scalar(src + i, count - i);
+      reduced = is_min ? std::min(reduced, tail) : std::max(reduced, tail);
+    }
+    return reduced;
+  }
+
+  template<bool is_min>
+  static float min_max_f32_sse2(const float *src, size_t count) noexcept
+  {
+    if (count < 4)
+      return is_min ? min_scalar(src, count) : max_scalar(src, count);
+
+    __m128 result = _mm_loadu_ps(src);
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4)
+      result = is_min ? _mm_min_ps(result, _mm_loadu_ps(src + i)) : _mm_max_ps(result, _mm_loadu_ps(src + i));
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, result);
+    float reduced = is_min ? min_scalar(lanes, 4) : max_scalar(lanes, 4);
+    if (i < count)
+    {
+      float tail = is_min ? min_scalar(src + i, count - i) : max_scalar(src + i, count - i);
+      reduced = is_min ? std::min(reduced, tail) : std::max(reduced, tail);
+    }
+    return reduced;
+  }
+
+  //
+  //avx2
+  //
+
+  SMALL_TL_TARGET_AVX2 static void fill16_avx2(uint16_t *dst, size_t count, uint16_t value) noexcept
+  {
+    __m256i broadcast = _mm256_set1_epi16((short)value);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+      _mm256_storeu_si256((__m256i *)(dst + i), broadcast);
+    fill_scalar(dst + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static void fill32_avx2(uint32_t *dst, size_t count, uint32_t value) noexcept
+  {
+    __m256i broadcast = _mm256_set1_epi32((int)value);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+      _mm256_storeu_si256((__m256i *)(dst + i), broadcast);
+    fill_scalar(dst + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static void fill64_avx2(uint64_t *dst, size_t count, uint64_t value) noexcept
+  {
+    __m256i broadcast = _mm256_set1_epi64x((long long)value);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+      _mm256_storeu_si256((__m256i *)(dst + i), broadcast);
+    fill_scalar(dst + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t find_u32_avx2(const uint32_t *src, size_t count, uint32_t value) noexcept
+  {
+    __m256i needle = _mm256_set1_epi32((int)value);
+    size_t i = 0;
+    //four vectors per test keeps the loop off the branch predictor's critical path
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256i equal0 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(src + i)), needle);
+      __m256i equal1 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(src + i + 8)), needle);
+      __m256i equal2 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(src + i + 16)), needle);
+      __m256i equal3 = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(src + i + 24)), needle);
+      __m256i any = _mm256_or_si256(_mm256_or_si256(equal0, equal1), _mm256_or_si256(equal2, equal3));
+      if (!_mm256_testz_si256(any, any))
+        break;
+    }
+    for (; i + 8 <= count; i += 8)
+    {
+      __m256i equal = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(src + i)), needle);
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(equal));
+      if (mask != 0)return i + count_trailing_zeros(mask);
+    }
+    return i + find_scalar(src + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t find_f32_avx2(const float *src, size_t count, float value) noexcept
+  {
+    __m256 needle = _mm256_set1_ps(value);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256 equal0 = _mm256_cmp_ps(_mm256_loadu_ps(src + i), needle, _CMP_EQ_OQ);
+      __m256 equal1 = _mm256_cmp_ps(_mm256_loadu_ps(src + i + 8), needle, _CMP_EQ_OQ);
+      __m256 equal2 = _mm256_cmp_ps(_mm256_loadu_ps(src + i + 16), needle, _CMP_EQ_OQ);
+      __m256 equal3 = _mm256_cmp_ps(_mm256_loadu_ps(src + i + 24), needle, _CMP_EQ_OQ);
+      __m256 any = _mm256_or_ps(_mm256_or_ps(equal0, equal1), _mm256_or_ps(equal2, equal3));
+      if (_mm256_movemask_ps(any) != 0)
+        break;
+    }
+    for (; i + 8 <= count; i += 8)
+    {
+      int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(src + i), needle, _CMP_EQ_OQ));
+      if (mask != 0)return i + count_trailing_zeros(mask);
+    }
+    return i + find_scalar(src + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t horizontal_sum_avx2(__m256i counters) noexcept
+  {
+    uint32_t lanes[8];
+    _mm256_storeu_si256((__m256i *)lanes, counters);
+    size_t sum = 0;
+    for (uint32_t lane : lanes)
+      sum += lane;
+    return sum;
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t count_u32_avx2(const uint32_t *src, size_t count, uint32_t value) noexcept
+  {
+    __m256i needle = _mm256_set1_epi32((int)value);
+    size_t matches = 0;
+    size_t i = 0;
+    while (i + 8 <= count)
+    {
+      __m256i counters = _mm256_setzero_si256();
+      size_t block_end = std::min(count & ~size_t(7), i + count_block);
+      for (; i < block_end; i += 8)
+        counters = _mm256_sub_epi32(counters, _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(src + i)), needle));
+      matches += horizontal_sum_avx2(counters);
+    }
+    return matches + count_scalar(src + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t count_f32_avx2(const float *src, size_t count, float value) noexcept
+  {
+    __m256 needle = _mm256_set1_ps(value);
+    size_t matches = 0;
+    size_t i = 0;
+    while (i + 8 <= count)
+    {
+      __m256i counters = _mm256_setzero_si256();
+      size_t block_end = std::min(count & ~size_t(7), i + count_block);
+      for (; i < block_end; i += 8)
+        counters = _mm256_sub_epi32(counters, _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(src + i), needle, _CMP_EQ_OQ)));
+      matches += horizontal_sum_avx2(counters);
+    }
+    return matches + count_scalar(src + i, count - i, value);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t mismatch_bytes_avx2(const uint8_t *lhs, const uint8_t *rhs, size_t byte_count) noexcept
+  {
+    size_t i = 0;
+    for (; i + 32 <= byte_count; i += 32)
+    {
+      __m256i equal = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(lhs + i)), _mm256_loadu_si256((const __m256i *)(rhs + i)));
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(equal);
+      if (mask != 0xFFFFFFFF)return i + count_trailing_zeros(~mask);
+    }
+    return i + mismatch_bytes_scalar(lhs + i, rhs + i, byte_count - i);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t mismatch_f32_avx2(const float *lhs, const float *rhs, size_t count) noexcept
+  {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+      uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(lhs + i), _mm256_loadu_ps(rhs + i), _CMP_EQ_OQ));
+      if (mask != 0xFF)return i + count_trailing_zeros(~mask);
+    }
+    return i + mismatch_f32_scalar(lhs + i, rhs + i, count - i);
+  }
+
+  SMALL_TL_TARGET_AVX2 static __m256i min_max_lanes_avx2(bool is_min, bool is_unsigned, __m256i a, __m256i b) noexcept
+  {
+    if (is_unsigned)
+      return is_min ? _mm256_min_epu32(a, b) : _mm256_max_epu32(a, b);
+    return is_min ? _mm256_min_epi32(a, b) : _mm256_max_epi32(a, b);
+  }
+
+  template<bool is_min, bool is_unsigned, class value_t>
+  SMALL_TL_TARGET_AVX2 static value_t min_max_i32_avx2(const value_t *src, size_t count) noexcept
+  {
+    if (count < 8)
+      return is_min ? min_scalar(src, count) : max_scalar(src, count);
+
+    __m256i result = _mm256_loadu_si256((const __m256i *)src);
+    size_t i = 8;
+    for (; i + 8 <= count; i += 8)
+      result = min_max_lanes_avx2(is_min, is_unsigned, result, _mm256_loadu_si256((const __m256i *)(src + i)));
+
+    value_t lanes[8];
+    _mm256_storeu_si256((__m256i *)lanes, result);
+    value_t reduced = is_min ? min_scalar(lanes, 8) : max_scalar(lanes, 8);
+    if (i < count)
+    {
+      value_t tail = is_min ? min_scalar(src + i, count - i) : max_scalar(src + i, count - i);
+      reduced = is_min ? std::min(reduced, tail) : std::max(reduced, tail);
+    }
+    return reduced;
+  }
+
+  template<bool is_min>
+  SMALL_TL_TARGET_AVX2 static float min_max_f32_avx2(const float *src, size_t count) noexcept
+  {
+    if (count < 8)
+      return is_min ? min_scalar(src, count) : max_scalar(src, count);
+
+    __m256 result = _mm256_loadu_ps(src);
+    size_t i = 8;
+    for (; i + 8 <= count; i += 8)
+      result = is_min ? _mm256_min_ps(result, _mm256_loadu_ps(src + i)) : _mm256_max_ps(result, _mm256_loadu_ps(src + i));
+
+    float lanes[8];
+    _mm256_storeu_ps(lanes, result);
+    float reduced = is_min ? min_scalar(lanes, 8) : max_scalar(lanes, 8);
+    if (i < count)
+    {
+      float tail = is_min ? min_scalar(src + i, count - i) : max_scalar(src + i, count - i);
+      reduced = is_min ? std::min(reduced, tail) : std::max(reduced, tail);
+    }
+    return reduced;
+  }
+#endif
+
+  //
+  //dispatch
+  //
+
+  struct kernels
+  {
+    void (*fill16)(uint16_t *, size_t, uint16_t) noexcept;
+    void (*fill32)(uint32_t *, size_t, uint32_t) noexcept;
+    void (*fill64)(uint64_t *, size_t, uint64_t) noexcept;
+    size_t (*find_u32)(const uint32_t *, size_t, uint32_t) noexcept;
+    size_t (*find_f32)(const float *, size_t, float) noexcept;
+    size_t (*count_u32)(const uint32_t *, size_t, uint32_t) noexcept;
+    size_t (*count_f32)(const float *, size_t, float) noexcept;
+    size_t (*mismatch_bytes)(const uint8_t *, const uint8_t *, size_t) noexcept;
+    size_t (*mismatch_f32)(const float *, const float *, size_t) noexcept;
+    uint32_t (*min_u32)(const uint32_t *, size_t) noexcept;
+    uint32_t (*max_u32)(const uint32_t *, size_t) noexcept;
+    int32_t (*min_i32)(const int32_t *, size_t) noexcept;
+    int32_t (*max_i32)(const int32_t *, size_t) noexcept;
+    float (*min_f32)(const float *, size_t) noexcept;
+    float (*max_f32)(const float *, size_t) noexcept;
+  };
+
+  static kernels select_kernels()
+  {
+    kernels selected = {
+      &fill_scalar<uint16_t>, &fill_scalar<uint32_t>, &fill_scalar<uint64_t>,
+      &find_scalar<uint32_t>, &find_scalar<float>,
+      &count_scalar<uint32_t>, &count_scalar<float>,
+      &mismatch_bytes_scalar, &mismatch_f32_scalar,
+      &min_scalar<uint32_t>, &max_scalar<uint32_t>,
+      &min_scalar<int32_t>, &max_scalar<int32_t>,
+      &min_scalar<float>, &max_scalar<float>
+    };
+#if defined(SMALL_TL_X86)
+    const cpu_features &features = get_cpu_features();
+    if (features.avx2)
+    {
+      selected = {
+        &fill16_avx2, &fill32_avx2, &fill64_avx2,
+        &find_u32_avx2, &find_f32_avx2,
+        &count_u32_avx2, &count_f32_avx2,
+        &mismatch_bytes_avx2, &mismatch_f32_avx2,
+        &min_max_i32_avx2<true, true, uint32_t>, &min_max_i32_avx2<false, true, uint32_t>,
+        &min_max_i32_avx2<true, false, int32_t>, &min_max_i32_avx2<false, false, int32_t>,
+        &min_max_f32_avx2<true>, &min_max_f32_avx2<false>
+      };
+    }
+    else if (features.sse2)
+    {
+      selected = {
+        &fill16_sse2, &fill32_sse2, &fill64_sse2,
+        &find_u32_sse2, &find_f32_sse2,
+        &count_u32_sse2, &count_f32_sse2,
+        &mismatch_bytes_sse2, &mismatch_f32_sse2,
+        &min_max_i32_sse2<true, true, uint32_t>, &min_max_i32_sse2<false, true, uint32_t>,
+        &min_max_i32_sse2<true, false, int32_t>, &min_max_i32_sse2<false, false, int32_t>,
+        &min_max_f32_sse2<true>, &min_max_f32_sse2<false>
+      };
+    }
+#endif
+    return selected;
+  }
+
+  static const kernels &get_kernels()
+  {
+    static const kernels selected = select_kernels();
+    return selected;
+  }
+
+  //
+  //entry points
+  //
+
+  void fill8(uint8_t *dst, size_t count, uint8_t value) noexcept { memset(dst, value, count); }
+  void fill16(uint16_t *dst, size_t count, uint16_t value) noexcept { get_kernels().fill16(dst, count, value); }
+  void fill32(uint32_t *dst, size_t count, uint32_t value) noexcept { get_kernels().fill32(dst, count, value); }
+  void fill64(uint64_t *dst, size_t count, uint64_t value) noexcept { get_kernels().fill64(dst, count, value); }
+
+  size_t find_u32(const uint32_t *src, size_t count, uint32_t value) noexcept { return get_kernels().find_u32(src, count, value); }
+  size_t find_f32(const float *src, size_t count, float value) noexcept { return get_kernels().find_f32(src, count, value); }
+  size_t count_u32(const uint32_t *src, size_t count, uint32_t value) noexcept { return get_kernels().count_u32(src, count, value); }
+  size_t count_f32(const float *src, size_t count, float value) noexcept { return get_kernels().count_f32(src, count, value); }
+
+  size_t mismatch_bytes(const void *lhs, const void *rhs, size_t byte_count) noexcept { return get_kernels().mismatch_bytes((const uint8_t *)lhs, (const uint8_t *)rhs, byte_count); }
+  size_t mismatch_f32(const float *lhs, const float *rhs, size_t count) noexcept { return get_kernels().mismatch_f32(lhs, rhs, count); }
+
+  uint32_t min_u32(const uint32_t *src, size_t count) noexcept { return get_kernels().min_u32(src, count); }
+  uint32_t max_u32(const uint32_t *src, size_t count) noexcept { return get_kernels().max_u32(src, count); }
+  int32_t min_i32(const int32_t *src, size_t count) noexcept { return get_kernels().min_i32(src, count); }
+  int32_t max_i32(const int32_t *src, size_t count) noexcept { return get_kernels().max_i32(src, count); }
+  float min_f32(const float *src, size_t count) noexcept { return get_kernels().min_f32(src, count); }
+  float max_f32(const float *src, size_t count) noexcept { return get_kernels().max_f32(src, count); }
+}
@@ -0,0 +1,161 @@
+#pragma once
+#include <type_traits>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace small_tl
+{
+  //vectorised bulk kernels over contiguous pod ranges, selected at runtime from sse2 and avx2 with a scalar fallback
+  //uint32_t, int32_t and float searches and reductions are vectorised, other types use the scalar algorithms
+  namespace simd
+  {
+    void fill8(uint8_t *dst, size_t count, uint8_t value) noexcept;
+    void fill16(uint16_t *dst, size_t count, uint16_t value) noexcept;
+    void fill32(uint32_t *dst, size_t count, uint32_t value) noexcept;
+    void fill64(uint64_t *dst, size_t count, uint64_t value) noexcept;
+
+    size_t find_u32(const uint32_t *src, size_t count, uint32_t value) noexcept;
+    size_t find_f32(const float *src, size_t count, float value) noexcept;
+    size_t count_u32(const uint32_t *src, size_t count, uint32_t value) noexcept;
+    size_t count_f32(const float *src, size_t count, float value) noexcept;
+
+    //index of the first differing byte, or byte_count
+    size_t mismatch_bytes(const void *lhs, const void *rhs, size_t byte_count) noexcept;
+    //index of the first element where lhs == rhs is false, or count
+    size_t mismatch_f32(const float *lhs, const float *rhs, size_t count) noexcept;
+
+    uint32_t min_u32(const uint32_t *src, size_t count) noexcept;
+    uint32_t max_u32(const uint32_t *src, size_t count) noexcept;
+    int32_t min_i32(const int32_t *src, size_t count) noexcept;
+    int32_t max_i32(const int32_t *src, size_t count) noexcept;
+    //nan ordering is unspecified
+    float min_f32(const float *src, size_t count) noexcept;
+    float max_f32(const float *src, size_t count) noexcept;
+
+    template<class pod_t>
+    struct is_vectorised : std::integral_constant<bool,
+      std::is_same<pod_t, uint32_t>::value || std::is_same<pod_t, int32_t>::value || std::is_same<pod_t, float>::value> {};
+
+    template<class pod_t, class bits_t>
+    bits_t bits_of(const pod_t &value) noexcept
+    {
+      bits_t bits;
+      memcpy(&bits, &value, sizeof(bits_t));
+      return bits;
+    }
+  }
+
+  //copies value into count elements starting at dst
+  template<class pod_t>
+  void simd_fill(pod_t *dst, size_t count, const pod_t &value) noexcept
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "simd_fill requires a trivial type");
+    if constexpr (sizeof(pod_t) == 1)
+      simd::fill8((uint8_t *)dst, count, simd::bits_of<pod_t, uint8_t>(value));
+    else if constexpr (sizeof(pod_t) == 2 && alignof(pod_t) >= 2)
+      simd::fill16((uint16_t *)dst, count, simd::bits_of<pod_t, uint16_t>(value));
+    else if constexpr (sizeof(pod_t) == 4 && alignof(pod_t) >= 4)
+      simd::fill32((uint32_t *)dst, count, simd::bits_of<pod_t, uint32_t>(value));
+    else if constexpr (sizeof(pod_t) == 8 && alignof(pod_t) >= 8)
+      simd::fill64((uint64_t *)dst, count, simd::bits_of<pod_t, uint64_t>(value));
+    else if (count > 0)
+    {
+      //replicate the value by doubling the initialised span each copy
+      memcpy(dst, &value, sizeof(pod_t));
+      size_t filled = 1;
+      while (filled < count)
+      {
+        size_t step = std::min(filled, count - filled);
+        memcpy(dst + filled, dst, step * sizeof(pod_t));
+        filled += step;
+      }
+    }
+  }
+
+  //index of the first element equal to value, or count
+  template<class pod_t>
+  size_t simd_find(const pod_t *src, size_t count, const pod_t &value) noexcept
+  {
+    if constexpr (std::is_same<pod_t, float>::value)
+      return simd::find_f32(src, count, value);
+    else if constexpr (simd::is_vectorised<pod_t>::value)
+      return simd::find_u32((const uint32_t *)src, count, (uint32_t)value);
+    else
+      return std::find(src, src + count, value) - src;
+  }
+
+  template<class pod_t>
+  size_t simd_count(const pod_t *src, size_t count, const pod_t &value) noexcept
+  {
+    if constexpr (std::is_same<pod_t, float>::value)
+      return simd::count_f32(src, count, value);
+    else if constexpr (simd::is_vectorised<pod_t>::value)
+      return simd::count_u32((const uint32_t *)src, count, (uint32_t)value);
+    else
+      return std::count(src, src + count, value);
+  }
+
+  //index of the first element where lhs and rhs differ, or count
+  template<class pod_t>
+  size_t simd_mismatch(const pod_t *lhs, const pod_t *rhs, size_t count) noexcept
+  {
+    if constexpr (std::is_same<pod_t, float>::value)
+      return simd::mismatch_f32(lhs, rhs, count);
+    else if constexpr (std::is_integral<pod_t>::value)
+      return simd::mismatch_bytes(lhs, rhs, count * sizeof(pod_t)) / sizeof(pod_t);
+    else
+      return std::mismatch(lhs, lhs + count, rhs).first - lhs;
+  }
+
+  template<class pod_t>
+  bool simd_equal(const pod_t *lhs, size_t lhs_count, const pod_t *rhs, size_t rhs_count) noexcept
+  {
+    return lhs_count == rhs_count && simd_mismatch(lhs, rhs, lhs_count) == lhs_count;
+  }
+
+  //lexicographic comparison, negative if lhs orders first, positive if rhs orders first
+  template<class pod_t>
+  int simd_compare(const pod_t *lhs, size_t lhs_count, const pod_t *rhs, size_t rhs_count) noexcept
+  {
+    size_t common = std::min(lhs_count, rhs_count);
+    size_t index = simd_mismatch(lhs, rhs, common);
+    if (index < common)
+    {
+      if (lhs[index] < rhs[index])return -1;
+      if (rhs[index] < lhs[index])return 1;
+      //unordered elements such as nan fall back to the scalar comparison from here
+      return std::lexicographical_compare(lhs + index, lhs + lhs_count, rhs + index, rhs + rhs_count) ? -1 :
+        std::lexicographical_compare(rhs + index, rhs + rhs_count, lhs + index, lhs + lhs_count) ? 1 : 0;
+    }
+    return lhs_count < rhs_count ? -1 : lhs_count > rhs_count ? 1 : 0;
+  }
+
+  //smallest element, count must not be zero
+  template<class pod_t>
+  pod_t simd_min(const pod_t *src, size_t count) noexcept
+  {
+    if constexpr (std::is_same<pod_t, uint32_t>::value)
+      return simd::min_u32(src, count);
+    else if constexpr (std::is_same<pod_t, int32_t>::value)
+      return simd::min_i32(src, count);
+    else if constexpr (std::is_same<pod_t, float>::value)
+      return simd::min_f32(src, count);
+    else
+      return *std::min_element(src, src + count);
+  }
+
+  //largest element, count must not be zero
+  template<class pod_t>
+  pod_t simd_max(const pod_t *src, size_t count) noexcept
+  {
+    if constexpr (std::is_same<pod_t, uint32_t>::value)
+      return simd::max_u32(src, count);
+    else if constexpr (std::is_same<pod_t, int32_t>::value)
+      return simd::max_i32(src, count);
+    else if constexpr (std::is_same<pod_t, float>::value)
+      return simd::max_f32(src, count);
+    else
+      return *std::max_element(src, src + count);
+  }
+}
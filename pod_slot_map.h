@@ -0,0 +1,172 @@
+#pragma once
+#include <type_traits>
+#include <limits>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "pod_allocator.h"
+#include "pod_vector.h"
+
+namespace small_tl
+{
+  //elements live densely in a pod_vector and are reached through handles that stay valid while the element is alive
+  //erase swaps the last element into the hole, a free list recycles slots and a generation count rejects stale handles
+  template<class pod_t, class allocator_t = pod_malloc_allocator>
+  class pod_slot_map
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "pod_slot_map requires a trivial type");
+  public:
+
+    typedef pod_t value_type;
+    typedef pod_t* iterator;
+    typedef const pod_t* const_iterator;
+
+    struct handle
+    {
+      uint32_t index;
+      //odd while the slot is occupied, so a default handle of generation 0 never resolves
+      uint32_t generation;
+
+      bool operator==(const handle &other) const noexcept { return index == other.index && generation == other.generation; }
+      bool operator!=(const handle &other) const noexcept { return !(*this == other); }
+    };
+
+    pod_slot_map() noexcept : pod_slot_map(allocator_t()) {}
+    explicit pod_slot_map(const allocator_t &allocator) noexcept : m_values(allocator), m_value_slots(allocator), m_slots(allocator), m_free_head(no_slot) {}
+
+    //a handle that never resolves if the allocator can not grow the map or every slot index is taken, the map is then unchanged
+    handle insert(const pod_t &value) noexcept
+    {
+      //the dense arrays grow first, their slot index is filled in once a slot is found
+      if (m_values.size() >= no_slot || !m_values.push_back(value))
+        return handle{ no_slot, 0 };
+      if (!m_value_slots.push_back(no_slot))
+      {
+        m_values.pop_back();
+        return handle{ no_slot, 0 };
+      }
+
+      uint32_t index = m_free_head;
+      if (index == no_slot)
+      {
+        if (m_slots.size() >= no_slot || !m_slots.push_back(slot{ 0, 0 }))
+        {
+          m_values.pop_back();
+          m_value_slots.pop_back();
+          return handle{ no_slot, 0 };
+        }
+        index = (uint32_t)m_slots.size() - 1;
+      }
+      else
+        m_free_head = m_slots[index].value_index;
+
+      slot &entry = m_slots[index];
+      entry.value_index = (uint32_t)m_values.size() - 1;
+      ++entry.generation;
+      m_value_slots.back() = index;
+      return handle{ index, entry.generation };
+    }
+
+    //false if the handle was already erased
+    bool erase(handle element) noexcept
+    {
+      if (!contains(element))
+        return false;
+
+      slot &entry = m_slots[element.index];
+      uint32_t last = (uint32_t)m_values.size() - 1;
+      if (entry.value_index != last)
+      {
+        memcpy(&m_values[entry.value_index], &m_values[last], sizeof(pod_t));
+        m_value_slots[entry.value_index] = m_value_slots[last];
+        m_slots[m_value_slots[last]].value_index = entry.value_index;
+      }
+      m_values.pop_back();
+      m_value_slots.pop_back();
+
+      ++entry.generation;
+      entry.value_index = m_free_head;
+      m_free_head = element.index;
+      return true;
+    }
+
+    bool contains(handle element) const noexcept
+    {
+      return element.index < m_slots.size() && m_slots[element.index].generation == element.generation && (element.generation & 1) != 0;
+    }
+
+    //nullptr for a stale handle
+    pod_t *find(handle element) noexcept { return contains(element) ? &m_values[m_slots[element.index].value_index] : nullptr; }
+    const pod_t *find(handle element) const noexcept { return contains(element) ? &m_values[m_slots[element.index].value_index] : nullptr; }
+
+    //the handle must be live
+    pod_t& operator [](handle element) noexcept
+    {
+      assert(contains(element));
+      return m_values[m_slots[element.index].value_index];
+    }
+    const pod_t& operator [](handle element) const noexcept
+    {
+      assert(contains(element));
+      return m_values[m_slots[element.index].value_index];
+    }
+
+    //the handle of the element at a position in the dense array, for use while iterating
+    handle handle_at(size_t pos) const noexcept
+    {
+      uint32_t index = m_value_slots[pos];
+      return handle{ index, m_slots[index].generation };
+    }
+
+    //iteration walks the dense array, the order changes when elements are erased
+    pod_t* data() noexcept { return m_values.data(); }
+    const pod_t* data() const noexcept { return m_values.data(); }
+
+    iterator begin() noexcept { return m_values.begin(); }
+    iterator end() noexcept { return m_values.end(); }
+    const_iterator begin() const noexcept { return m_values.begin(); }
+    const_iterator end() const noexcept { return m_values.end(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_values.empty(); }
+
+    size_t size() const noexcept { return m_values.size(); }
+
+    //false if any of the arrays could not grow, those that did keep their larger capacity
+    bool reserve(size_t new_cap) noexcept
+    {
+      return m_values.reserve(new_cap) && m_value_slots.reserve(new_cap) && m_slots.reserve(new_cap);
+    }
+
+    //every outstanding handle becomes stale
+    void clear() noexcept
+    {
+      while (!m_values.empty())
+        erase(handle_at(m_values.size() - 1));
+    }
+
+    void swap(pod_slot_map &other) noexcept
+    {
+      m_values.swap(other.m_values);
+      m_value_slots.swap(other.m_value_slots);
+      m_slots.swap(other.m_slots);
+      std::swap(m_free_head, other.m_free_head);
+    }
+
+  private:
+    static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+
+    struct slot
+    {
+      //the element's position in m_values while occupied, the next free slot otherwise
+      uint32_t value_index;
+      uint32_t generation;
+    };
+
+    pod_vector<pod_t, allocator_t> m_values;
+    pod_vector<uint32_t, allocator_t> m_value_slots;
+    pod_vector<slot, allocator_t> m_slots;
+    uint32_t m_free_head;
+  };
+}
@@ -0,0 +1,361 @@
+#pragma once
+#include <type_traits>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "pod_allocator.h"
+#include "pod_growth.h"
+#include "pod_simd.h"
+#include "pod_io.h"
+
+namespace small_tl
+{
+  //a pod_vector that keeps up to inline_capacity elements inside the object and only allocates once it overflows
+  //allocator_t and growth_t are the same policies pod_vector takes, and only apply once the elements leave the object
+  template<class pod_t, size_t inline_capacity, class allocator_t = pod_malloc_allocator, class growth_t = pod_growth_double>
+  class pod_small_vector
+  {
+    static_assert(std::is_trivially_copyable<pod_t>::value, "pod_small_vector requires a trivial type");
+    static_assert(inline_capacity > 0, "pod_small_vector requires an inline capacity");
+  public:
+
+    typedef pod_t value_type;
+    typedef allocator_t allocator_type;
+    typedef growth_t growth_type;
+    typedef pod_t* iterator;
+    typedef const pod_t* const_iterator;
+
+    pod_small_vector() noexcept : pod_small_vector(allocator_t()) {}
+
+    explicit pod_small_vector(const allocator_t &allocator) noexcept : m_allocator(allocator), m_capacity(inline_capacity), m_size(0), m_bytes_copied(0), m_ptr(inline_data()) {}
+
+    pod_small_vector(const pod_small_vector &other) = delete;
+    pod_small_vector &operator=(const pod_small_vector &other) = delete;
+
+    pod_small_vector(pod_small_vector &&other) noexcept : m_allocator(other.m_allocator), m_capacity(inline_capacity), m_size(0), m_bytes_copied(0), m_ptr(inline_data())
+    {
+      take(other);
+    }
+
+    pod_small_vector &operator=(pod_small_vector &&other) noexcept
+    {
+      if (this != &other)
+      {
+        release();
+        m_allocator = other.m_allocator;
+        take(other);
+      }
+      return *this;
+    }
+
+    ~pod_small_vector() noexcept { release(); }
+
+    allocator_t get_allocator() const noexcept { return m_allocator; }
+
+    pod_t& at(size_t pos) noexcept { return m_ptr[pos]; }
+    const pod_t& at(size_t pos) const noexcept { return m_ptr[pos]; }
+
+    pod_t& operator [](size_t pos) noexcept { return at(pos); }
+    const pod_t& operator [](size_t pos) const noexcept { return at(pos); }
+
+    pod_t& front() noexcept { return at(0); }
+    const pod_t& front() const noexcept { return at(0); }
+
+    pod_t& back() noexcept { return at(m_size-1); }
+    const pod_t& back() const noexcept { return at(m_size-1); }
+
+    pod_t* data() noexcept { return m_ptr; }
+    const pod_t* data() const noexcept { return m_ptr; }
+
+    iterator begin() noexcept { return m_ptr; }
+    iterator end() noexcept { return m_ptr + m_size; }
+    const_iterator begin() const noexcept { return m_ptr; }
+    const_iterator end() const noexcept { return m_ptr + m_size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t max_size() const noexcept { return std::numeric_limits<size_t>::max() / sizeof(pod_t); }
+
+    //true while the elements still live inside the object
+    bool is_inline() const noexcept { return m_ptr == inline_data(); }
+
+    //the growing members return false, or nullptr for insert, if the allocator can not provide the block, the vector is then unchanged
+    bool reserve(size_t new_cap) noexcept
+    {
+      if (new_cap <= m_capacity)return true;
+      return reallocate(growth_t::reserve(new_cap));
+    }
+
+    size_t capacity() const noexcept { return m_capacity; }
+
+    void shrink_to_fit() noexcept { resize(m_size); }
+
+    void clear() noexcept { m_size = 0; }
+
+    iterator insert(iterator pos, const pod_t& value) noexcept { return insert(pos, 1, value); }
+    const_iterator insert(const_iterator pos, const pod_t& value) noexcept { return insert(const_cast<iterator>(pos), 1, value); }
+    iterator insert(iterator pos, size_t count, const pod_t& value) noexcept
+    {
+      //value may reference an element the gap is about to move
+      alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+      memcpy(copy, &value, sizeof(pod_t));
+      pos = make_gap(pos, count);
+      if (pos == nullptr || count == 0)return pos;
+
+      simd_fill(pos, count, *reinterpret_cast<const pod_t *>(copy));
+      return pos;
+    }
+    iterator insert(iterator pos, const_iterator first, const_iterator last) noexcept
+    {
+      size_t count = last - first;
+      //the source may live inside this vector, so copy it out of the way before opening the gap
+      if (first >= begin() && first < end())
+      {
+        pod_small_vector copy(m_allocator);
+        if (copy.insert(copy.begin(), first, last) == nullptr)
+          return nullptr;
+        return insert(pos, copy.cbegin(), copy.cend());
+      }
+
+      pos = make_gap(pos, count);
+      if (pos == nullptr)
+        return nullptr;
+      memmove(pos, first, count * sizeof(pod_t));
+      return pos;
+    }
+
+    iterator erase(iterator pos) noexcept { return erase(pos, pos + 1); }
+    iterator erase(iterator first, iterator last) noexcept
+    {
+      memmove(first, last, (end() - last) * sizeof(pod_t));
+      m_size -= last - first;
+      return first;
+    }
+
+    bool push_back(const pod_t& value) noexcept
+    {
+      if (m_size == m_capacity)
+      {
+        //value may reference an element we are about to move
+        alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+        memcpy(copy, &value, sizeof(pod_t));
+        if (!reallocate(growth_t::grow(m_capacity, m_size + 1)))
+          return false;
+        memcpy(end(), copy, sizeof(pod_t));
+      }
+      else
+        memcpy(end(), &value, sizeof(pod_t));
+      ++m_size;
+      return true;
+    }
+
+    void pop_back() noexcept
+    {
+      --m_size;
+    }
+
+    //sets the capacity, moving the elements back inline when they fit
+    bool resize(size_t new_cap) noexcept { return reallocate(new_cap); }
+
+    bool resize(size_t count, const pod_t &value) noexcept
+    {
+      if (count > m_size)
+        return insert(end(), count - m_size, value) != nullptr;
+      m_size = count;
+      return true;
+    }
+
+    void swap(pod_small_vector &other) noexcept
+    {
+      pod_small_vector tmp(std::move(other));
+      other = std::move(*this);
+      *this = std::move(tmp);
+    }
+
+    //bytes physically copied by growth, moving off or back onto the inline storage always copies
+    size_t bytes_copied() const noexcept { return m_bytes_copied; }
+
+    //the same pod_header layout as pod_vector, see pod_io.h
+#if !defined(_WIN32)
+    bool write_to(int fd) const noexcept { return write_pod_range(fd, data(), sizeof(pod_t), m_size); }
+#endif
+    bool write_to(std::ostream &stream) const { return write_pod_range(stream, data(), sizeof(pod_t), m_size); }
+
+    //appends the elements written by write_to, on failure the size is unchanged
+#if !defined(_WIN32)
+    bool read_from(int fd) noexcept
+    {
+      size_t count;
+      if (!read_pod_header(fd, sizeof(pod_t), count) || !make_room_for(count))
+        return false;
+      if (!read_pod_bytes(fd, end(), count * sizeof(pod_t)))
+        return false;
+      m_size += count;
+      return true;
+    }
+#endif
+    bool read_from(std::istream &stream)
+    {
+      size_t count;
+      if (!read_pod_header(stream, sizeof(pod_t), count) || !make_room_for(count))
+        return false;
+      if (!read_pod_bytes(stream, end(), count * sizeof(pod_t)))
+        return false;
+      m_size += count;
+      return true;
+    }
+
+  private:
+    pod_t *inline_data() noexcept { return reinterpret_cast<pod_t *>(m_inline); }
+    const pod_t *inline_data() const noexcept { return reinterpret_cast<const pod_t *>(m_inline); }
+
+    //moves the elements to a block of new_cap, inside the object when it fits, a failed allocator leaves everything as it was
+    bool reallocate(size_t new_cap) noexcept
+    {
+      new_cap = std::max(new_cap, inline_capacity);
+      if (new_cap == m_capacity)return true;
+      if (new_cap > max_size())
+        return false;
+
+      size_t kept = std::min(new_cap, m_size);
+      pod_t *new_ptr;
+      if (new_cap == inline_capacity)
+      {
+        new_ptr = inline_data();
+        memcpy(new_ptr, m_ptr, kept * sizeof(pod_t));
+        m_bytes_copied += kept * sizeof(pod_t);
+        m_allocator.deallocate(m_ptr, m_capacity * sizeof(pod_t));
+      }
+      else if (is_inline())
+      {
+        new_ptr = (pod_t *)m_allocator.allocate(new_cap * sizeof(pod_t));
+        if (new_ptr == nullptr)
+          return false;
+        memcpy(new_ptr, m_ptr, kept * sizeof(pod_t));
+        m_bytes_copied += kept * sizeof(pod_t);
+      }
+      else
+      {
+        //already on the heap, so the allocator can grow the block in place
+        new_ptr = (pod_t *)m_allocator.reallocate(m_ptr, m_capacity * sizeof(pod_t), new_cap * sizeof(pod_t), m_bytes_copied);
+        if (new_ptr == nullptr)
+          return false;
+      }
+      m_ptr = new_ptr;
+      m_capacity = new_cap;
+      m_size = kept;
+      return true;
+    }
+
+    //exact growth for count more elements, a count past what the block could ever address is refused before anything is allocated
+    bool make_room_for(size_t count) noexcept
+    {
+      if (count > max_size() - m_size)
+        return false;
+      return m_size + count <= m_capacity || reallocate(m_size + count);
+    }
+
+    //opens count uninitialised elements at pos, growing if required, nullptr if growing fails
+    iterator make_gap(iterator pos, size_t count) noexcept
+    {
+      size_t gap_offset = pos - begin();
+      if (count > max_size() - m_size)
+        return nullptr;
+      if (count + m_size > m_capacity)
+      {
+        if (!resize_with_gap(growth_t::grow(m_capacity, count + m_size), gap_offset, count))
+          return nullptr;
+      }
+      else
+        memmove(m_ptr + gap_offset + count, m_ptr + gap_offset, (m_size - gap_offset) * sizeof(pod_t));
+      m_size += count;
+      return m_ptr + gap_offset;
+    }
+
+    //leaving the inline storage copies the elements either side of the gap straight to their final positions
+    //a heap block grows through the allocator and the tail slides up within it
+    bool resize_with_gap(size_t new_cap, size_t gap_offset, size_t gap_size) noexcept
+    {
+      assert(gap_offset <= m_size);
+      if (!is_inline())
+      {
+        if (!reallocate(new_cap))
+          return false;
+        memmove(m_ptr + gap_offset + gap_size, m_ptr + gap_offset, (m_size - gap_offset) * sizeof(pod_t));
+        return true;
+      }
+
+      if (new_cap > max_size())
+        return false;
+      pod_t *new_ptr = (pod_t *)m_allocator.allocate(new_cap * sizeof(pod_t));
+      if (new_ptr == nullptr)
+        return false;
+      memcpy(new_ptr, m_ptr, gap_offset * sizeof(pod_t));
+      memcpy(new_ptr + gap_offset + gap_size, m_ptr + gap_offset, (m_size - gap_offset) * sizeof(pod_t));
+      m_bytes_copied += m_size * sizeof(pod_t);
+      m_ptr = new_ptr;
+      m_capacity = new_cap;
+      return true;
+    }
+
+    void take(pod_small_vector &other) noexcept
+    {
+      if (other.is_inline())
+      {
+        memcpy(inline_data(), other.inline_data(), other.m_size * sizeof(pod_t));
+        m_ptr = inline_data();
+        m_capacity = inline_capacity;
+      }
+      else
+      {
+        m_ptr = other.m_ptr;
+        m_capacity = other.m_capacity;
+      }
+      m_size = other.m_size;
+      m_bytes_copied = other.m_bytes_copied;
+      other.m_ptr = other.inline_data();
+      other.m_capacity = inline_capacity;
+      other.m_size = 0;
+      other.m_bytes_copied = 0;
+    }
+
+    void release() noexcept
+    {
+      if (!is_inline())
+        m_allocator.deallocate(m_ptr, m_capacity * sizeof(pod_t));
+      m_ptr = inline_data();
+      m_capacity = inline_capacity;
+      m_size = 0;
+    }
+
+    allocator_t m_allocator;
+    size_t m_capacity;
+    size_t m_size;
+    size_t m_bytes_copied;
+    pod_t *m_ptr;
+    alignas(pod_t) unsigned char m_inline[inline_capacity * sizeof(pod_t)];
+  };
+
+  template<class pod_t, size_t inline_capacity, class allocator_t, class growth_t>
+  bool operator==(const pod_small_vector<pod_t, inline_capacity, allocator_t, growth_t> &lhs, const pod_small_vector<pod_t, inline_capacity, allocator_t, growth_t> &rhs) noexcept
+  {
+    return simd_equal(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+  }
+
+  template<class pod_t, size_t inline_capacity, class allocator_t, class growth_t>
+  bool operator!=(const pod_small_vector<pod_t, inline_capacity, allocator_t, growth_t> &lhs, const pod_small_vector<pod_t, inline_capacity, allocator_t, growth_t> &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  template<class pod_t, size_t inline_capacity, class allocator_t, class growth_t>
+  bool operator<(const pod_small_vector<pod_t, inline_capacity, allocator_t, growth_t> &lhs, const pod_small_vector<pod_t, inline_capacity, allocator_t, growth_t> &rhs) noexcept
+  {
+    return simd_compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
+  }
+}
@@ -0,0 +1,285 @@
+#pragma once
+#include <type_traits>
+#include <tuple>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "pod_allocator.h"
+#include "pod_span.h"
+
+namespace small_tl
+{
+  //a structure of arrays, each field is stored in its own contiguous array so a pass over one field only touches that field's cache lines
+  //every array starts on a 64 byte boundary and all of them share a single block, so growth is one allocation for all fields
+  //allocator_t provides the block, see pod_allocator.h, the fields are a pack so it comes first and pod_soa_vector below picks the default
+  template<class allocator_t, class... fields_t>
+  class basic_pod_soa_vector
+  {
+    static_assert(sizeof...(fields_t) > 0, "pod_soa_vector requires at least one field");
+    static_assert((std::is_trivially_copyable<fields_t>::value && ...), "pod_soa_vector requires trivial field types");
+  public:
+    static constexpr size_t field_count = sizeof...(fields_t);
+    static constexpr size_t array_alignment = 64;
+
+    template<size_t field_index>
+    using field_t = typename std::tuple_element<field_index, std::tuple<fields_t...>>::type;
+
+    typedef std::tuple<fields_t...> value_type;
+    typedef allocator_t allocator_type;
+
+    //proxy for one row, reads and writes go straight to the field arrays
+    template<class owner_t>
+    class basic_reference
+    {
+    public:
+      basic_reference(owner_t *owner, size_t index) noexcept : m_owner(owner), m_index(index) {}
+
+      template<size_t field_index>
+      auto &get() const noexcept { return m_owner->template field<field_index>()[m_index]; }
+
+      operator value_type() const noexcept { return m_owner->row(m_index); }
+
+      const basic_reference &operator=(const value_type &value) const noexcept
+      {
+        m_owner->set_row(m_index, value, std::index_sequence_for<fields_t...>());
+        return *this;
+      }
+      const basic_reference &operator=(const basic_reference &other) const noexcept { return *this = (value_type)other; }
+
+      friend void swap(const basic_reference &lhs, const basic_reference &rhs) noexcept
+      {
+        value_type row = lhs;
+        lhs = (value_type)rhs;
+        rhs = row;
+      }
+
+    private:
+      owner_t *m_owner;
+      size_t m_index;
+    };
+
+    typedef basic_reference<basic_pod_soa_vector> reference;
+    typedef basic_reference<const basic_pod_soa_vector> const_reference;
+
+    template<class owner_t>
+    class basic_iterator
+    {
+    public:
+      typedef std::random_access_iterator_tag iterator_category;
+      typedef typename basic_pod_soa_vector::value_type value_type;
+      typedef ptrdiff_t difference_type;
+      typedef basic_reference<owner_t> reference;
+      typedef void pointer;
+
+      basic_iterator() noexcept : m_owner(nullptr), m_index(0) {}
+      basic_iterator(owner_t *owner, size_t index) noexcept : m_owner(owner), m_index(index) {}
+
+      reference operator*() const noexcept { return reference(m_owner, m_index); }
+      reference operator[](difference_type offset) const noexcept { return reference(m_owner, m_index + offset); }
+
+      basic_iterator &operator++() noexcept { ++m_index; return *this; }
+      basic_iterator &operator--() noexcept { --m_index; return *this; }
+      basic_iterator operator++(int) noexcept { basic_iterator previous = *this; ++m_index; return previous; }
+      basic_iterator operator--(int) noexcept { basic_iterator previous = *this; --m_index; return previous; }
+      basic_iterator &operator+=(difference_type offset) noexcept { m_index += offset; return *this; }
+      basic_iterator &operator-=(difference_type offset) noexcept { m_index -= offset; return *this; }
+      basic_iterator operator+(difference_type offset) const noexcept { return basic_iterator(m_owner, m_index + offset); }
+      basic_iterator operator-(difference_type offset) const noexcept { return basic_iterator(m_owner, m_index - offset); }
+      difference_type operator-(const basic_iterator &other) const noexcept { return (difference_type)m_index - (difference_type)other.m_index; }
+
+      bool operator==(const basic_iterator &other) const noexcept { return m_index == other.m_index; }
+      bool operator!=(const basic_iterator &other) const noexcept { return m_index != other.m_index; }
+      bool operator<(const basic_iterator &other) const noexcept { return m_index < other.m_index; }
+      bool operator>(const basic_iterator &other) const noexcept { return m_index > other.m_index; }
+      bool operator<=(const basic_iterator &other) const noexcept { return m_index <= other.m_index; }
+      bool operator>=(const basic_iterator &other) const noexcept { return m_index >= other.m_index; }
+
+      size_t index() const noexcept { return m_index; }
+
+    private:
+      owner_t *m_owner;
+      size_t m_index;
+    };
+
+    typedef basic_iterator<basic_pod_soa_vector> iterator;
+    typedef basic_iterator<const basic_pod_soa_vector> const_iterator;
+
+    basic_pod_soa_vector() noexcept : basic_pod_soa_vector(allocator_t()) {}
+    explicit basic_pod_soa_vector(const allocator_t &allocator) noexcept : m_allocator(allocator), m_capacity(0), m_size(0), m_block(nullptr), m_block_bytes(0), m_arrays() {}
+
+    basic_pod_soa_vector(const basic_pod_soa_vector &) = delete;
+    basic_pod_soa_vector &operator=(const basic_pod_soa_vector &) = delete;
+
+    basic_pod_soa_vector(basic_pod_soa_vector &&other) noexcept : basic_pod_soa_vector(other.m_allocator) { swap(other); }
+    basic_pod_soa_vector &operator=(basic_pod_soa_vector &&other) noexcept
+    {
+      basic_pod_soa_vector moved(std::move(other));
+      swap(moved);
+      return *this;
+    }
+
+    ~basic_pod_soa_vector() { m_allocator.deallocate(m_block, m_block_bytes); }
+
+    allocator_t get_allocator() const noexcept { return m_allocator; }
+
+    //the contiguous array holding one field of every row
+    template<size_t field_index>
+    pod_span<field_t<field_index>> field() noexcept { return pod_span<field_t<field_index>>((field_t<field_index> *)m_arrays[field_index], m_size); }
+    template<size_t field_index>
+    pod_span<const field_t<field_index>> field() const noexcept { return pod_span<const field_t<field_index>>((const field_t<field_index> *)m_arrays[field_index], m_size); }
+
+    reference operator [](size_t pos) noexcept { return reference(this, pos); }
+    const_reference operator [](size_t pos) const noexcept { return const_reference(this, pos); }
+
+    reference front() noexcept { return (*this)[0]; }
+    reference back() noexcept { return (*this)[m_size - 1]; }
+
+    value_type row(size_t pos) const noexcept { return row(pos, std::index_sequence_for<fields_t...>()); }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+    iterator end() noexcept { return iterator(this, m_size); }
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+    const_iterator end() const noexcept { return const_iterator(this, m_size); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    size_t size() const noexcept { return m_size; }
+
+    size_t capacity() const noexcept { return m_capacity; }
+
+    //reserve and push_back return false if the allocator can not provide the block, the vector is then unchanged
+    bool reserve(size_t new_cap) noexcept
+    {
+      if (new_cap <= m_capacity)return true;
+      if (new_cap > std::numeric_limits<size_t>::max() - 32)return false;
+      return reallocate(new_cap + (32 - (new_cap % 32)));
+    }
+
+    void shrink_to_fit() noexcept { reallocate(m_size); }
+
+    void clear() noexcept { m_size = 0; }
+
+    bool push_back(const fields_t&... values) noexcept
+    {
+      if (m_size == m_capacity && !reallocate(std::max<size_t>(m_capacity * 2, 32)))
+        return false;
+      set_row(m_size, std::forward_as_tuple(values...), std::index_sequence_for<fields_t...>());
+      ++m_size;
+      return true;
+    }
+
+    bool push_back(const value_type &value) noexcept
+    {
+      if (m_size == m_capacity && !reallocate(std::max<size_t>(m_capacity * 2, 32)))
+        return false;
+      set_row(m_size, value, std::index_sequence_for<fields_t...>());
+      ++m_size;
+      return true;
+    }
+
+    void pop_back() noexcept
+    {
+      --m_size;
+    }
+
+    iterator erase(iterator pos) noexcept { return erase(pos, pos + 1); }
+    iterator erase(iterator first, iterator last) noexcept
+    {
+      size_t first_index = first.index();
+      size_t last_index = last.index();
+      erase_fields(first_index, last_index);
+      m_size -= last_index - first_index;
+      return iterator(this, first_index);
+    }
+
+    void swap(basic_pod_soa_vector &other) noexcept
+    {
+      std::swap(m_allocator, other.m_allocator);
+      std::swap(m_capacity, other.m_capacity);
+      std::swap(m_size, other.m_size);
+      std::swap(m_block, other.m_block);
+      std::swap(m_block_bytes, other.m_block_bytes);
+      std::swap(m_arrays, other.m_arrays);
+    }
+
+  private:
+    static constexpr size_t field_sizes[field_count] = { sizeof(fields_t)... };
+
+    static size_t align_up(size_t bytes) noexcept { return (bytes + array_alignment - 1) & ~(array_alignment - 1); }
+
+    template<class tuple_t, size_t... field_index>
+    void set_row(size_t pos, const tuple_t &value, std::index_sequence<field_index...>) noexcept
+    {
+      ((((field_t<field_index> *)m_arrays[field_index])[pos] = std::get<field_index>(value)), ...);
+    }
+
+    template<size_t... field_index>
+    value_type row(size_t pos, std::index_sequence<field_index...>) const noexcept
+    {
+      return value_type(((const field_t<field_index> *)m_arrays[field_index])[pos]...);
+    }
+
+    void erase_fields(size_t first, size_t last) noexcept
+    {
+      for (size_t field_index = 0; field_index < field_count; ++field_index)
+      {
+        char *array = (char *)m_arrays[field_index];
+        size_t field_size = field_sizes[field_index];
+        memmove(array + first * field_size, array + last * field_size, (m_size - last) * field_size);
+      }
+    }
+
+    //one block for every field, each array copied once into its new home
+    //a capacity whose block size would overflow or a failed allocator leaves the old block in place
+    bool reallocate(size_t new_cap) noexcept
+    {
+      size_t offsets[field_count];
+      size_t bytes = 0;
+      for (size_t field_index = 0; field_index < field_count; ++field_index)
+      {
+        if (new_cap > (std::numeric_limits<size_t>::max() - bytes - 2 * array_alignment) / field_sizes[field_index])
+          return false;
+        offsets[field_index] = bytes;
+        bytes = align_up(bytes + new_cap * field_sizes[field_index]);
+      }
+
+      //allocators may only promise max_align_t, so leave room to align the first array
+      size_t block_bytes = bytes + array_alignment;
+      char *block = (char *)m_allocator.allocate(block_bytes);
+      if (block == nullptr)
+        return false;
+      char *base = (char *)(((uintptr_t)block + array_alignment - 1) & ~(uintptr_t)(array_alignment - 1));
+
+      m_size = std::min(m_size, new_cap);
+      for (size_t field_index = 0; field_index < field_count; ++field_index)
+      {
+        if (m_arrays[field_index] != nullptr)
+          memcpy(base + offsets[field_index], m_arrays[field_index], m_size * field_sizes[field_index]);
+        m_arrays[field_index] = base + offsets[field_index];
+      }
+
+      m_allocator.deallocate(m_block, m_block_bytes);
+      m_block = block;
+      m_block_bytes = block_bytes;
+      m_capacity = new_cap;
+      return true;
+    }
+
+    allocator_t m_allocator;
+    size_t m_capacity;
+    size_t m_size;
+    void *m_block;
+    size_t m_block_bytes;
+    void *m_arrays[field_count];
+  };
+
+  //the default storage, pod_soa_vector<float, float, uint32_t> and so on
+  template<class... fields_t>
+  using pod_soa_vector = basic_pod_soa_vector<pod_malloc_allocator, fields_t...>;
+}
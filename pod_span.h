@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <type_traits>
+
+namespace small_tl
+{
+  //a non owning view of a contiguous run of elements
+  template<class pod_t>
+  class pod_span
+  {
+  public:
+    typedef pod_t value_type;
+    typedef pod_t* iterator;
+
+    pod_span() noexcept : m_ptr(nullptr), m_size(0) {}
+    pod_span(pod_t *ptr, size_t size) noexcept : m_ptr(ptr), m_size(size) {}
+    pod_span(pod_t *first, pod_t *last) noexcept : m_ptr(first), m_size(last - first) {}
+    template<size_t count>
+    pod_span(pod_t (&array)[count]) noexcept : m_ptr(array), m_size(count) {}
+
+    //a span of mutable elements converts to a span of const elements
+    template<class other_t, typename std::enable_if<std::is_same<const other_t, pod_t>::value && !std::is_same<other_t, pod_t>::value, other_t>::type * = nullptr>
+    pod_span(const pod_span<other_t> &other) noexcept : m_ptr(other.data()), m_size(other.size()) {}
+
+    pod_t& operator [](size_t pos) const noexcept { return m_ptr[pos]; }
+
+    pod_t* data() const noexcept { return m_ptr; }
+    iterator begin() const noexcept { return m_ptr; }
+    iterator end() const noexcept { return m_ptr + m_size; }
+
+    size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return m_size == 0; }
+
+    pod_span subspan(size_t offset, size_t count) const noexcept { return pod_span(m_ptr + offset, count); }
+    pod_span subspan(size_t offset) const noexcept { return pod_span(m_ptr + offset, m_size - offset); }
+
+  private:
+    pod_t *m_ptr;
+    size_t m_size;
+  };
+}
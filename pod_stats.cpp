@@ -0,0 +1,96 @@
+#include "pod_stats.h"
+#include <algorithm>
+#include <ostream>
+#include <cstdlib>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace small_tl
+{
+  //types register once and are never removed, so the list only needs an atomic push
+  static std::atomic<pod_type_stats *> registry_head(nullptr);
+
+  pod_type_stats::pod_type_stats(const char *type_name, size_t element_size) noexcept :
+    m_type_name(type_name), m_element_size(element_size), m_vectors(0), m_reallocations(0), m_bytes_copied(0),
+    m_peak_capacity_bytes(0), m_live_capacity_bytes(0), m_wasted_capacity_bytes(0), m_next(registry_head.load(std::memory_order_relaxed))
+  {
+    while (!registry_head.compare_exchange_weak(m_next, this, std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  void pod_type_stats::record_create() noexcept
+  {
+    m_vectors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void pod_type_stats::record_reallocation(size_t old_capacity, size_t new_capacity, size_t bytes_copied) noexcept
+  {
+    size_t new_bytes = new_capacity * m_element_size;
+    m_reallocations.fetch_add(1, std::memory_order_relaxed);
+    m_bytes_copied.fetch_add(bytes_copied, std::memory_order_relaxed);
+    m_live_capacity_bytes.fetch_add(new_bytes - old_capacity * m_element_size, std::memory_order_relaxed);
+
+    size_t peak = m_peak_capacity_bytes.load(std::memory_order_relaxed);
+    while (peak < new_bytes && !m_peak_capacity_bytes.compare_exchange_weak(peak, new_bytes, std::memory_order_relaxed));
+  }
+
+  void pod_type_stats::record_destroy(size_t capacity, size_t size) noexcept
+  {
+    m_live_capacity_bytes.fetch_sub(capacity * m_element_size, std::memory_order_relaxed);
+    m_wasted_capacity_bytes.fetch_add((capacity - size) * m_element_size, std::memory_order_relaxed);
+  }
+
+  static std::string readable_name(const char *name)
+  {
+#if defined(__GNUC__)
+    int status = 0;
+    char *demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (status == 0 && demangled != nullptr)
+    {
+      std::string result(demangled);
+      free(demangled);
+      return result;
+    }
+#endif
+    return name;
+  }
+
+  pod_stats_snapshot pod_type_stats::snapshot() const
+  {
+    pod_stats_snapshot result;
+    result.type_name = readable_name(m_type_name);
+    result.element_size = m_element_size;
+    result.vectors = m_vectors.load(std::memory_order_relaxed);
+    result.reallocations = m_reallocations.load(std::memory_order_relaxed);
+    result.bytes_copied = m_bytes_copied.load(std::memory_order_relaxed);
+    result.peak_capacity_bytes = m_peak_capacity_bytes.load(std::memory_order_relaxed);
+    result.live_capacity_bytes = m_live_capacity_bytes.load(std::memory_order_relaxed);
+    result.wasted_capacity_bytes = m_wasted_capacity_bytes.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  std::vector<pod_stats_snapshot> get_pod_stats()
+  {
+    std::vector<pod_stats_snapshot> result;
+    for (pod_type_stats *stats = registry_head.load(std::memory_order_acquire); stats != nullptr; stats = stats->m_next)
+      result.push_back(stats->snapshot());
+    return result;
+  }
+
+  void dump_pod_stats(std::ostream &stream)
+  {
+    std::vector<pod_stats_snapshot> stats = get_pod_stats();
+    std::sort(stats.begin(), stats.end(), [](const pod_stats_snapshot &lhs, const pod_stats_snapshot &rhs) { return lhs.wasted_capacity_bytes > rhs.wasted_capacity_bytes; });
+    for (const pod_stats_snapshot &type : stats)
+    {
+      stream << type.type_name << " (" << type.element_size << " bytes)"
+        << " vectors " << type.vectors
+        << " reallocations " << type.reallocations
+        << " bytes_copied " << type.bytes_copied
+        << " peak_capacity_bytes " << type.peak_capacity_bytes
+        << " live_capacity_bytes " << type.live_capacity_bytes
+        << " wasted_capacity_bytes " << type.wasted_capacity_bytes << '\n';
+    }
+  }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <iosfwd>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include <cstddef>
+
+//define SMALL_TL_POD_STATS to have every pod_vector report its growth here, without it the hooks compile away
+namespace small_tl
+{
+  struct pod_stats_snapshot
+  {
+    std::string type_name;
+    size_t element_size;
+    size_t vectors;                 //vectors constructed
+    size_t reallocations;           //capacity changes, including the first allocation
+    size_t bytes_copied;            //bytes the allocator physically copied while growing
+    size_t peak_capacity_bytes;     //the largest capacity any one vector reached
+    size_t live_capacity_bytes;     //capacity held by vectors that still exist
+    size_t wasted_capacity_bytes;   //capacity left unused when vectors were destroyed
+  };
+
+  //counters shared by every pod_vector of one element type, updated with relaxed atomics
+  class pod_type_stats
+  {
+    pod_type_stats(const pod_type_stats &) = delete;
+    pod_type_stats &operator=(const pod_type_stats &) = delete;
+
+  public:
+    //adds itself to the registry that get_pod_stats walks
+    pod_type_stats(const char *type_name, size_t element_size) noexcept;
+
+    void record_create() noexcept;
+    void record_reallocation(size_t old_capacity, size_t new_capacity, size_t bytes_copied) noexcept;
+    void record_destroy(size_t capacity, size_t size) noexcept;
+
+    pod_stats_snapshot snapshot() const;
+
+  private:
+    friend std::vector<pod_stats_snapshot> get_pod_stats();
+
+    const char *m_type_name;
+    size_t m_element_size;
+    std::atomic<size_t> m_vectors;
+    std::atomic<size_t> m_reallocations;
+    std::atomic<size_t> m_bytes_copied;
+    std::atomic<size_t> m_peak_capacity_bytes;
+    std::atomic<size_t> m_live_capacity_bytes;
+    std::atomic<size_t> m_wasted_capacity_bytes;
+    pod_type_stats *m_next;
+  };
+
+  template<class pod_t>
+  pod_type_stats &pod_stats_for() noexcept
+  {
+    static pod_type_stats stats(typeid(pod_t).name(), sizeof(pod_t));
+    return stats;
+  }
+
+  //one snapshot per element type that has been used, in no particular order
+  std::vector<pod_stats_snapshot> get_pod_stats();
+
+  //a line per element type, largest wasted capacity first
+  void dump_pod_stats(std::ostream &stream);
+}
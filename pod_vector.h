@@ -3,23 +3,63 @@
 #include <limits>
 #include <memory>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include "pod_allocator.h"
+#include "pod_growth.h"
+#include "pod_simd.h"
+#include "pod_io.h"
+
+#if defined(SMALL_TL_POD_STATS)
+#include "pod_stats.h"
+#endif
 
 namespace small_tl
 {
-  template<class pod_t>
+  //allocator_t provides allocate, reallocate and deallocate over raw bytes, see pod_allocator.h
+  //growth_t picks the capacities to grow to, see pod_growth.h
+  template<class pod_t, class allocator_t = pod_malloc_allocator, class growth_t = pod_growth_double>
   class pod_vector
   {
     static_assert(std::is_trivially_copyable<pod_t>::value, "pod_vector requires a trivial type");
   public:
 
+    typedef pod_t value_type;
+    typedef allocator_t allocator_type;
+    typedef growth_t growth_type;
     typedef pod_t* iterator;
     typedef const pod_t* const_iterator;
 
-    pod_vector() noexcept : m_size(0), m_ptr(nullptr, &std::free)
+    pod_vector() noexcept : pod_vector(allocator_t()) {}
+
+    explicit pod_vector(const allocator_t &allocator) noexcept : m_capacity(0), m_size(0), m_bytes_copied(0), m_ptr(nullptr, storage_deleter{ allocator, 0 })
     {
+#if defined(SMALL_TL_POD_STATS)
+      pod_stats_for<pod_t>().record_create();
+#endif
       resize(32);
     }
 
+    pod_vector(pod_vector &&other) noexcept : m_capacity(other.m_capacity), m_size(other.m_size), m_bytes_copied(other.m_bytes_copied), m_ptr(std::move(other.m_ptr))
+    {
+#if defined(SMALL_TL_POD_STATS)
+      pod_stats_for<pod_t>().record_create();
+#endif
+      other.m_capacity = other.m_size = 0;
+    }
+    pod_vector &operator=(pod_vector &&other) noexcept
+    {
+      pod_vector moved(std::move(other));
+      swap(moved);
+      return *this;
+    }
+
+#if defined(SMALL_TL_POD_STATS)
+    ~pod_vector() { pod_stats_for<pod_t>().record_destroy(m_capacity, m_size); }
+#endif
+
+    allocator_t get_allocator() const noexcept { return m_ptr.get_deleter().allocator; }
+
     pod_t& at(size_t pos) noexcept { return m_ptr.get()[pos]; }
     const pod_t& at(size_t pos) const noexcept { return m_ptr.get()[pos]; }
 
@@ -32,8 +72,13 @@ namespace small_tl
     pod_t& back() noexcept { return at(m_size-1); }
     const pod_t& back() const noexcept { return at(m_size-1); }
 
+    pod_t* data() noexcept { return m_ptr.get(); }
+    const pod_t* data() const noexcept { return m_ptr.get(); }
+
     iterator begin() noexcept { return m_ptr.get(); }
     iterator end() noexcept { return m_ptr.get() + m_size; }
+    const_iterator begin() const noexcept { return m_ptr.get(); }
+    const_iterator end() const noexcept { return m_ptr.get() + m_size; }
     const_iterator cbegin() const noexcept { return begin(); }
     const_iterator cend() const noexcept { return end(); }
 
@@ -43,10 +88,11 @@ namespace small_tl
 
     size_t max_size() const noexcept { return std::numeric_limits<size_t>::max(); }
 
-    void reserve(size_t new_cap) noexcept
+    //the growing members return false, or nullptr for insert, if the allocator can not provide the block, the vector is then unchanged
+    bool reserve(size_t new_cap) noexcept
     {
-      if (new_cap < m_capacity)return;
-      resize(new_cap + (32 - (new_cap % 32)));
+      if (new_cap <= m_capacity)return true;
+      return reallocate(growth_t::reserve(new_cap));
     }
 
     size_t capacity() const noexcept { return m_capacity; }
@@ -59,48 +105,58 @@ namespace small_tl
     const_iterator insert(const_iterator pos, const pod_t& value) noexcept { return insert(pos, 1, value); }
     iterator insert(iterator pos, size_t count, const pod_t& value) noexcept
     {
+      //value may reference an element the gap is about to move
+      alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+      memcpy(copy, &value, sizeof(pod_t));
       if (count + m_size > m_capacity)
-        pos = resize_with_gap(count + m_size, pos-m_ptr.get(), count);
+        pos = resize_with_gap(growth_t::grow(m_capacity, count + m_size), pos - m_ptr.get(), count);
       else
-        memmove(pos + count, pos, end() - pos);
+        memmove(pos + count, pos, (end() - pos) * sizeof(pod_t));
+      if (pos == nullptr)
+        return nullptr;
 
-      memcpy(pos, &value, sizeof(pod_t));
-      iterator dst = pos + 1;
-      for (uint16_t i = 0; i < std::floor(sqrt(count)); ++i)
-      {
-        memcpy(pos, dst, (1 << i) * sizeof(pod_t));
-        dst += (1 << i);
-      }
+      simd_fill(pos, count, *reinterpret_cast<const pod_t *>(copy));
       m_size += count;
       return pos;
     }
     iterator insert(iterator pos, const_iterator first, const_iterator last) noexcept
     {
-      size_t count = (last - first) / sizeof(pod_t);
+      size_t count = last - first;
       if (count + m_size > m_capacity)
-        pos = resize_with_gap(count + m_size, pos - m_ptr.get(), count);
+        pos = resize_with_gap(growth_t::grow(m_capacity, count + m_size), pos - m_ptr.get(), count);
       else
-        memmove(pos + count, pos, end() - pos);
+        memmove(pos + count, pos, (end() - pos) * sizeof(pod_t));
+      if (pos == nullptr)
+        return nullptr;
 
-      memcpy(pos, first, last - first);
+      memcpy(pos, first, count * sizeof(pod_t));
       m_size += count;
       return pos;
     }
 
-    iterator erase(iterator pos) noexcept { return erase(pos, pos); }
+    iterator erase(iterator pos) noexcept { return erase(pos, pos + 1); }
     iterator erase(iterator first, iterator last) noexcept
     {
-      memmove(first, last, end() - last);
-      m_size -= (last - first)/sizeof(pod_t);
+      memmove(first, last, (end() - last) * sizeof(pod_t));
+      m_size -= last - first;
       return first;
     }
 
-    void push_back(const pod_t& value) noexcept
+    bool push_back(const pod_t& value) noexcept
     {
-      if (m_capacity < m_size)
-        resize(m_capacity * 2);
-      memcpy(end(), &value, sizeof(pod_t));
+      if (m_size == m_capacity)
+      {
+        //value may reference an element that growth is about to move
+        alignas(pod_t) unsigned char copy[sizeof(pod_t)];
+        memcpy(copy, &value, sizeof(pod_t));
+        if (!reallocate(growth_t::grow(m_capacity, m_size + 1)))
+          return false;
+        memcpy(end(), copy, sizeof(pod_t));
+      }
+      else
+        memcpy(end(), &value, sizeof(pod_t));
       ++m_size;
+      return true;
     }
 
     void pop_back() noexcept
@@ -108,44 +164,135 @@ namespace small_tl
       --m_size;
     }
 
-    void resize(size_t new_cap) noexcept
+    bool resize(size_t new_cap) noexcept
     {
+      if (!reallocate(new_cap))
+        return false;
       m_size = std::min(new_cap, m_size);
-      m_capacity = new_cap;
-      pod_t *new_ptr = (pod_t *)std::malloc(m_capacity * sizeof(pod_t));
-      memcpy(new_ptr, m_ptr.get(), m_size * sizeof(pod_t));
-      m_ptr.reset(new_ptr);
+      return true;
     }
 
-    void resize(size_t count, const pod_t &value) noexcept
+    bool resize(size_t count, const pod_t &value) noexcept
     {
-      if (count > m_capacity)
-        insert(end(), count - m_capacity)
-      else
-        resize(count);
+      if (count > m_size)
+        return insert(end(), count - m_size, value) != nullptr;
+      return resize(count);
     }
 
-    void swap(pod_vector<pod_t> other) noexcept
+    void swap(pod_vector &other) noexcept
     {
       m_ptr.swap(other.m_ptr);
       std::swap(m_capacity, other.m_capacity);
-      std::swap(m_size, other.size);
+      std::swap(m_size, other.m_size);
+      std::swap(m_bytes_copied, other.m_bytes_copied);
+    }
+
+    //bytes physically copied by growth, realloc extending in place and mremap moving pages copy nothing
+    size_t bytes_copied() const noexcept { return m_bytes_copied; }
+
+    //writes a pod_header and then the elements straight from the block, see pod_io.h
+#if !defined(_WIN32)
+    bool write_to(int fd) const noexcept { return write_pod_range(fd, data(), sizeof(pod_t), m_size); }
+#endif
+    bool write_to(std::ostream &stream) const { return write_pod_range(stream, data(), sizeof(pod_t), m_size); }
+
+    //appends the elements written by write_to, they are read directly into the tail so clear first to replace the contents
+    //on failure the size is unchanged, and so is the capacity if the header's count is refused or can not be allocated
+#if !defined(_WIN32)
+    bool read_from(int fd) noexcept
+    {
+      size_t count;
+      if (!read_pod_header(fd, sizeof(pod_t), count) || !make_room_for(count))
+        return false;
+      if (!read_pod_bytes(fd, end(), count * sizeof(pod_t)))
+        return false;
+      m_size += count;
+      return true;
+    }
+#endif
+    bool read_from(std::istream &stream)
+    {
+      size_t count;
+      if (!read_pod_header(stream, sizeof(pod_t), count) || !make_room_for(count))
+        return false;
+      if (!read_pod_bytes(stream, end(), count * sizeof(pod_t)))
+        return false;
+      m_size += count;
+      return true;
     }
 
   private:
-    iterator resize_with_gap(size_t new_cap, size_t gap_offset, size_t gap_size) noexcept
+    struct storage_deleter
     {
-      m_size = std::min(new_cap, m_size-gap_size);
-      assert(gap_offset < m_size);
+      allocator_t allocator;
+      size_t bytes;
+      void operator()(pod_t *ptr) noexcept { allocator.deallocate(ptr, bytes); }
+    };
+
+    //grows the block in place where the allocator can, the elements keep their offsets
+    //a failed allocator leaves the old block valid, so the block is only handed over once the new one exists
+    bool reallocate(size_t new_cap) noexcept
+    {
+      if (new_cap > max_size() / sizeof(pod_t))
+        return false;
+      size_t new_bytes = new_cap * sizeof(pod_t);
+      storage_deleter &storage = m_ptr.get_deleter();
+#if defined(SMALL_TL_POD_STATS)
+      size_t bytes_copied_before = m_bytes_copied;
+#endif
+      pod_t *new_ptr = (pod_t *)storage.allocator.reallocate(m_ptr.get(), m_capacity * sizeof(pod_t), new_bytes, m_bytes_copied);
+      if (new_ptr == nullptr && new_bytes != 0)
+        return false;
+#if defined(SMALL_TL_POD_STATS)
+      pod_stats_for<pod_t>().record_reallocation(m_capacity, new_cap, m_bytes_copied - bytes_copied_before);
+#endif
+      m_ptr.release();
+      m_ptr.reset(new_ptr);
+      storage.bytes = new_bytes;
       m_capacity = new_cap;
-      pod_t *new_ptr = (pod_t *)std::malloc(m_capacity * sizeof(pod_t));
-      memcpy(new_ptr, m_ptr.get(), gap_offset*sizeof(pod_t));
-      memcpy(new_ptr+((gap_offset+gap_size)*sizeof(pod_t)), m_ptr.get() +(gap_offset * sizeof(pod_t)), gap_size * sizeof(pod_t));
-      return new_ptr + (gap_offset * sizeof(pod_t));
+      return true;
+    }
+
+    //exact growth for count more elements, a count past what the block could ever address is refused before anything is allocated
+    bool make_room_for(size_t count) noexcept
+    {
+      if (count > max_size() / sizeof(pod_t) - m_size)
+        return false;
+      return m_size + count <= m_capacity || reallocate(m_size + count);
+    }
+
+    //grows then slides the tail up, so the head is never copied and the tail only moves within the block
+    iterator resize_with_gap(size_t new_cap, size_t gap_offset, size_t gap_size) noexcept
+    {
+      assert(gap_offset <= m_size);
+      if (!reallocate(new_cap))
+        return nullptr;
+      pod_t *gap = m_ptr.get() + gap_offset;
+      memmove(gap + gap_size, gap, (m_size - gap_offset) * sizeof(pod_t));
+      return gap;
     }
 
     size_t m_capacity;
     size_t m_size;
-    std::unique_ptr<pod_t, decltype(&std::free)> m_ptr;
+    size_t m_bytes_copied;
+    std::unique_ptr<pod_t, storage_deleter> m_ptr;
   };
-}
\ No newline at end of file
+
+  template<class pod_t, class allocator_t, class growth_t>
+  bool operator==(const pod_vector<pod_t, allocator_t, growth_t> &lhs, const pod_vector<pod_t, allocator_t, growth_t> &rhs) noexcept
+  {
+    return simd_equal(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+  }
+
+  template<class pod_t, class allocator_t, class growth_t>
+  bool operator!=(const pod_vector<pod_t, allocator_t, growth_t> &lhs, const pod_vector<pod_t, allocator_t, growth_t> &rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+  template<class pod_t, class allocator_t, class growth_t>
+  bool operator<(const pod_vector<pod_t, allocator_t, growth_t> &lhs, const pod_vector<pod_t, allocator_t, growth_t> &rhs) noexcept
+  {
+    return simd_compare(lhs.data(), lhs.size(), rhs.data(), rhs.size()) < 0;
+  }
+}
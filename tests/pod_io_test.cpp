@@ -0,0 +1,117 @@
+#include "../pod_vector.h"
+#include <cstdio>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+using namespace small_tl;
+
+static int failures = 0;
+
+static void check(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    std::printf("FAILED: %s\n", what);
+    ++failures;
+  }
+}
+
+//the count is the last field of the header
+static void set_header_count(std::string &bytes, uint64_t count)
+{
+  memcpy(&bytes[sizeof(pod_header) - sizeof(uint64_t)], &count, sizeof(count));
+}
+
+static void oversized_count_from_stream()
+{
+  pod_vector<uint64_t> written;
+  written.push_back(42);
+  std::ostringstream out;
+  check(written.write_to(out), "stream write");
+
+  std::string bytes = out.str();
+  set_header_count(bytes, uint64_t(1) << 61);
+  std::istringstream in(bytes);
+  pod_vector<uint64_t> read;
+  size_t capacity = read.capacity();
+  check(!read.read_from(in), "stream count past max_size is refused");
+  check(read.size() == 0 && read.capacity() == capacity, "stream refusal leaves size and capacity");
+}
+
+#if !defined(_WIN32)
+static void truncated_file()
+{
+  pod_vector<int> written;
+  for (int i = 0; i < 100; ++i)
+    written.push_back(i);
+  FILE *file = std::tmpfile();
+  int fd = fileno(file);
+  check(written.write_to(fd), "fd write");
+  check(ftruncate(fd, sizeof(pod_header) + 10 * sizeof(int)) == 0, "truncate");
+
+  lseek(fd, 0, SEEK_SET);
+  pod_vector<int> read;
+  size_t capacity = read.capacity();
+  check(!read.read_from(fd), "truncated file is refused");
+  check(read.size() == 0 && read.capacity() == capacity, "truncated refusal leaves size and capacity");
+  std::fclose(file);
+}
+
+static void oversized_count_from_file()
+{
+  pod_vector<uint64_t> written;
+  written.push_back(42);
+  std::ostringstream out;
+  written.write_to(out);
+  std::string bytes = out.str();
+
+  const uint64_t counts[] = { uint64_t(1) << 61, uint64_t(1) << 40, 2 };
+  for (uint64_t count : counts)
+  {
+    set_header_count(bytes, count);
+    FILE *file = std::tmpfile();
+    int fd = fileno(file);
+    check(write(fd, bytes.data(), bytes.size()) == (ssize_t)bytes.size(), "fd write");
+    lseek(fd, 0, SEEK_SET);
+
+    pod_vector<uint64_t> read;
+    size_t capacity = read.capacity();
+    check(!read.read_from(fd), "count beyond the file is refused");
+    check(read.size() == 0 && read.capacity() == capacity, "fd refusal leaves size and capacity");
+    std::fclose(file);
+  }
+}
+
+static void round_trip_file()
+{
+  pod_vector<int> written;
+  for (int i = 0; i < 1000; ++i)
+    written.push_back(i);
+  FILE *file = std::tmpfile();
+  int fd = fileno(file);
+  check(written.write_to(fd), "fd write");
+  lseek(fd, 0, SEEK_SET);
+
+  pod_vector<int> read;
+  check(read.read_from(fd) && read == written, "fd round trip");
+  std::fclose(file);
+}
+#endif
+
+int main()
+{
+  oversized_count_from_stream();
+#if !defined(_WIN32)
+  truncated_file();
+  oversized_count_from_file();
+  round_trip_file();
+#endif
+  if (failures == 0)
+    std::printf("pod_io_test passed\n");
+  return failures == 0 ? 0 : 1;
+}
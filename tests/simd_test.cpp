@@ -0,0 +1,209 @@
+#include "../pod_simd.h"
+#include "../cpu_features.h"
+#include <cstdio>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace small_tl;
+
+//ctest runs this once per dispatch tier with SMALL_TL_CPU_LIMIT set, every kernel is checked against a plain loop
+
+static int failures = 0;
+
+static void check(bool condition, const char *what, size_t length, size_t position)
+{
+  if (!condition)
+  {
+    std::printf("FAILED: %s, length %zu position %zu\n", what, length, position);
+    ++failures;
+  }
+}
+
+//either side of the vector widths, the unroll and a full 255 step block of byte counters
+static std::vector<size_t> test_lengths()
+{
+  std::vector<size_t> lengths;
+  for (size_t length = 0; length <= 8; ++length)
+    lengths.push_back(length);
+  for (size_t base : { 16, 32, 64, 255 * 32 })
+    for (size_t length = base - 1; length <= base + 1; ++length)
+      lengths.push_back(length);
+  return lengths;
+}
+
+//where the interesting element goes, the ends, the lane and block boundaries and the middle
+static std::vector<size_t> test_positions(size_t length)
+{
+  std::vector<size_t> positions;
+  for (size_t position : { size_t(0), size_t(1), size_t(3), size_t(4), size_t(7), size_t(8), size_t(15), size_t(16), size_t(31), size_t(32), size_t(63), length / 2, length - 2, length - 1 })
+    if (position < length)
+      positions.push_back(position);
+  return positions;
+}
+
+static std::mt19937 random_engine(12345);
+
+template<class value_t>
+static void fill_kernel(void (*kernel)(value_t *, size_t, value_t) noexcept, const char *what)
+{
+  const value_t value = (value_t)0xA5A5A5A5A5A5A5A5ull;
+  for (size_t length : test_lengths())
+  {
+    //one element of slack either side catches writes out of range, the offset start catches alignment assumptions
+    for (size_t offset = 0; offset < 2; ++offset)
+    {
+      std::vector<value_t> buffer(length + 3, 0);
+      kernel(buffer.data() + 1 + offset, length, value);
+      bool filled = true;
+      for (size_t i = 0; i < buffer.size(); ++i)
+        filled &= buffer[i] == (i >= 1 + offset && i < 1 + offset + length ? value : 0);
+      check(filled, what, length, offset);
+    }
+  }
+}
+
+static void fill_kernels()
+{
+  fill_kernel<uint8_t>(&simd::fill8, "fill8");
+  fill_kernel<uint16_t>(&simd::fill16, "fill16");
+  fill_kernel<uint32_t>(&simd::fill32, "fill32");
+  fill_kernel<uint64_t>(&simd::fill64, "fill64");
+}
+
+template<class value_t>
+static size_t find_reference(const value_t *src, size_t count, value_t value)
+{
+  for (size_t i = 0; i < count; ++i)
+    if (src[i] == value)return i;
+  return count;
+}
+
+template<class value_t>
+static size_t count_reference(const value_t *src, size_t count, value_t value)
+{
+  size_t matches = 0;
+  for (size_t i = 0; i < count; ++i)
+    matches += src[i] == value;
+  return matches;
+}
+
+template<class value_t>
+static void search_kernels(size_t (*find)(const value_t *, size_t, value_t) noexcept, size_t (*count)(const value_t *, size_t, value_t) noexcept, const char *find_what, const char *count_what)
+{
+  const value_t needle = (value_t)7;
+  for (size_t length : test_lengths())
+  {
+    std::vector<value_t> values(length + 1);
+    for (value_t &value : values)
+      value = (value_t)(random_engine() % 1000 + 10);
+    //offset by one element so the loads are not aligned
+    value_t *src = values.data() + 1;
+
+    check(find(src, length, needle) == length, find_what, length, length);
+    check(count(src, length, needle) == 0, count_what, length, length);
+    for (size_t position : test_positions(length))
+    {
+      src[position] = needle;
+      check(find(src, length, needle) == find_reference(src, length, needle), find_what, length, position);
+      check(count(src, length, needle) == count_reference(src, length, needle), count_what, length, position);
+    }
+
+    //a dense mix of matches for the counters
+    for (size_t i = 0; i < length; ++i)
+      src[i] = (value_t)(random_engine() % 3 + 6);
+    check(find(src, length, needle) == find_reference(src, length, needle), find_what, length, 0);
+    check(count(src, length, needle) == count_reference(src, length, needle), count_what, length, 0);
+  }
+}
+
+static void mismatch_kernels()
+{
+  for (size_t length : test_lengths())
+  {
+    std::vector<uint8_t> lhs_bytes(length + 1), rhs_bytes(length + 1);
+    for (size_t i = 0; i <= length; ++i)
+      lhs_bytes[i] = rhs_bytes[i] = (uint8_t)random_engine();
+    check(simd::mismatch_bytes(lhs_bytes.data() + 1, rhs_bytes.data() + 1, length) == length, "mismatch_bytes", length, length);
+    for (size_t position : test_positions(length))
+    {
+      rhs_bytes[1 + position] ^= 0x80;
+      check(simd::mismatch_bytes(lhs_bytes.data() + 1, rhs_bytes.data() + 1, length) == position, "mismatch_bytes", length, position);
+      rhs_bytes[1 + position] ^= 0x80;
+    }
+
+    std::vector<float> lhs(length + 1), rhs(length + 1);
+    for (size_t i = 0; i <= length; ++i)
+      lhs[i] = rhs[i] = (float)(random_engine() % 1000) - 500.5f;
+    check(simd::mismatch_f32(lhs.data() + 1, rhs.data() + 1, length) == length, "mismatch_f32", length, length);
+    for (size_t position : test_positions(length))
+    {
+      float saved = rhs[1 + position];
+      rhs[1 + position] += 1.0f;
+      check(simd::mismatch_f32(lhs.data() + 1, rhs.data() + 1, length) == position, "mismatch_f32", length, position);
+      //nan never compares equal, even to itself
+      lhs[1 + position] = rhs[1 + position] = std::numeric_limits<float>::quiet_NaN();
+      check(simd::mismatch_f32(lhs.data() + 1, rhs.data() + 1, length) == position, "mismatch_f32 nan", length, position);
+      lhs[1 + position] = rhs[1 + position] = saved;
+    }
+  }
+}
+
+template<class value_t>
+static void min_max_kernel(value_t (*min)(const value_t *, size_t) noexcept, value_t (*max)(const value_t *, size_t) noexcept, const char *min_what, const char *max_what)
+{
+  for (size_t length : test_lengths())
+  {
+    if (length == 0)
+      continue;
+    std::vector<value_t> values(length + 1);
+    for (value_t &value : values)
+      value = (value_t)((int64_t)(random_engine() % 2001) - 1000);
+    value_t *src = values.data() + 1;
+    for (size_t position : test_positions(length))
+    {
+      //the extremes of the type land at each position in turn, including the sign bit for the unsigned compare
+      value_t saved = src[position];
+      src[position] = std::numeric_limits<value_t>::lowest();
+      check(min(src, length) == std::numeric_limits<value_t>::lowest(), min_what, length, position);
+      src[position] = std::numeric_limits<value_t>::max();
+      check(max(src, length) == std::numeric_limits<value_t>::max(), max_what, length, position);
+      src[position] = saved;
+
+      value_t lowest = src[0], highest = src[0];
+      for (size_t i = 1; i < length; ++i)
+      {
+        lowest = src[i] < lowest ? src[i] : lowest;
+        highest = src[i] > highest ? src[i] : highest;
+      }
+      check(min(src, length) == lowest, min_what, length, position);
+      check(max(src, length) == highest, max_what, length, position);
+    }
+  }
+}
+
+static void min_max_kernels()
+{
+  min_max_kernel<uint32_t>(&simd::min_u32, &simd::max_u32, "min_u32", "max_u32");
+  min_max_kernel<int32_t>(&simd::min_i32, &simd::max_i32, "min_i32", "max_i32");
+  min_max_kernel<float>(&simd::min_f32, &simd::max_f32, "min_f32", "max_f32");
+}
+
+static const char *dispatch_tier()
+{
+  const cpu_features &features = get_cpu_features();
+  return features.avx2 ? "avx2" : features.sse2 ? "sse2" : "scalar";
+}
+
+int main()
+{
+  fill_kernels();
+  search_kernels<uint32_t>(&simd::find_u32, &simd::count_u32, "find_u32", "count_u32");
+  search_kernels<float>(&simd::find_f32, &simd::count_f32, "find_f32", "count_f32");
+  mismatch_kernels();
+  min_max_kernels();
+  if (failures == 0)
+    std::printf("simd_test passed on the %s kernels\n", dispatch_tier());
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,362 @@
+#include "../utf/utf_simd.h"
+#include "../cpu_features.h"
+#include <cstdio>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace small_tl;
+namespace utf_simd = small_tl::utf_convert::simd;
+
+//ctest runs this once per dispatch tier with SMALL_TL_CPU_LIMIT set, every kernel is checked against a plain loop
+
+static int failures = 0;
+
+static void check(bool condition, const char *what, size_t length, size_t position)
+{
+  if (!condition)
+  {
+    std::printf("FAILED: %s, length %zu position %zu\n", what, length, position);
+    ++failures;
+  }
+}
+
+//either side of the vector widths, the unroll and a full 255 step block of byte counters
+static std::vector<size_t> test_lengths()
+{
+  std::vector<size_t> lengths;
+  for (size_t length = 0; length <= 8; ++length)
+    lengths.push_back(length);
+  for (size_t base : { 16, 32, 64, 255 * 32 })
+    for (size_t length = base - 1; length <= base + 1; ++length)
+      lengths.push_back(length);
+  return lengths;
+}
+
+//where the interesting unit goes, the ends, the lane and block boundaries and the middle
+static std::vector<size_t> test_positions(size_t length)
+{
+  std::vector<size_t> positions;
+  for (size_t position : { size_t(0), size_t(1), size_t(14), size_t(15), size_t(16), size_t(30), size_t(31), size_t(32), size_t(62), size_t(63), size_t(64), length / 2, length - 3, length - 2, length - 1 })
+    if (position < length)
+      positions.push_back(position);
+  return positions;
+}
+
+static std::mt19937 random_engine(12345);
+
+static void append_utf8(std::string &text, char32_t code_point)
+{
+  if (code_point < 0x80)
+    text += (char)code_point;
+  else if (code_point < 0x800)
+  {
+    text += (char)(0xC0 | (code_point >> 6));
+    text += (char)(0x80 | (code_point & 0x3F));
+  }
+  else if (code_point < 0x10000)
+  {
+    text += (char)(0xE0 | (code_point >> 12));
+    text += (char)(0x80 | ((code_point >> 6) & 0x3F));
+    text += (char)(0x80 | (code_point & 0x3F));
+  }
+  else
+  {
+    text += (char)(0xF0 | (code_point >> 18));
+    text += (char)(0x80 | ((code_point >> 12) & 0x3F));
+    text += (char)(0x80 | ((code_point >> 6) & 0x3F));
+    text += (char)(0x80 | (code_point & 0x3F));
+  }
+}
+
+//a valid code point of one to four utf8 bytes, ascii with the given odds out of 4
+static char32_t random_code_point(uint32_t ascii_odds)
+{
+  if (random_engine() % 4 < ascii_odds)
+    return random_engine() % 0x80;
+  switch (random_engine() % 3)
+  {
+  case 0: return 0x80 + random_engine() % (0x800 - 0x80);
+  case 1:
+  {
+    char32_t code_point = 0x800 + random_engine() % (0x10000 - 0x800);
+    return code_point >= 0xD800 && code_point < 0xE000 ? code_point + 0x800 : code_point;
+  }
+  default: return 0x10000 + random_engine() % (0x110000 - 0x10000);
+  }
+}
+
+//valid utf8 cut to exactly length bytes, the last character is replaced by ascii when it would not fit
+static std::string random_utf8(size_t length, uint32_t ascii_odds)
+{
+  std::string text;
+  while (text.size() < length)
+  {
+    std::string character;
+    append_utf8(character, random_code_point(ascii_odds));
+    text += text.size() + character.size() <= length ? character : std::string(1, 'a');
+  }
+  return text;
+}
+
+//
+//references, the same rules as the scalar kernels written as plainly as possible
+//
+
+static size_t validate_utf8_reference(const std::string &text)
+{
+  size_t i = 0;
+  while (i < text.size())
+  {
+    uint8_t lead = (uint8_t)text[i];
+    size_t length = lead < 0x80 ? 1 : (lead & 0xE0) == 0xC0 ? 2 : (lead & 0xF0) == 0xE0 ? 3 : (lead & 0xF8) == 0xF0 ? 4 : 0;
+    if (length == 0 || text.size() - i < length)
+      return i;
+    char32_t code_point = length == 1 ? lead : lead & (0x7F >> length);
+    for (size_t k = 1; k < length; ++k)
+    {
+      uint8_t byte = (uint8_t)text[i + k];
+      if ((byte & 0xC0) != 0x80)
+        return i;
+      code_point = (code_point << 6) | (byte & 0x3F);
+    }
+    static const char32_t shortest[5] = { 0, 0, 0x80, 0x800, 0x10000 };
+    if (code_point < shortest[length] || code_point > 0x10FFFF || (code_point >= 0xD800 && code_point < 0xE000))
+      return i;
+    i += length;
+  }
+  return text.size();
+}
+
+static size_t validate_utf16_reference(const std::u16string &text)
+{
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    if (text[i] >= 0xDC00 && text[i] < 0xE000)
+      return i;
+    if (text[i] >= 0xD800 && text[i] < 0xDC00)
+    {
+      if (i + 1 == text.size() || text[i + 1] < 0xDC00 || text[i + 1] >= 0xE000)
+        return i;
+      ++i;
+    }
+  }
+  return text.size();
+}
+
+static void ascii_kernels()
+{
+  for (size_t length : test_lengths())
+  {
+    std::string text = random_utf8(length, 4);
+    std::u16string units(text.begin(), text.end());
+    std::vector<char16_t> wide16(length + 1, 0xFFFF);
+    std::vector<char32_t> wide32(length + 1, 0xFFFF);
+    std::vector<char> narrow(length + 1, 0);
+
+    check(utf_simd::widen_ascii(text.data(), length, wide16.data()) == length, "widen_ascii utf16", length, length);
+    check(utf_simd::widen_ascii(text.data(), length, wide32.data()) == length, "widen_ascii utf32", length, length);
+    check(utf_simd::narrow_ascii(units.data(), length, narrow.data()) == length, "narrow_ascii", length, length);
+    check(std::u16string(wide16.data(), length) == units, "widen_ascii utf16 copy", length, length);
+    check(std::u32string(wide32.data(), length) == std::u32string(text.begin(), text.end()), "widen_ascii utf32 copy", length, length);
+    check(std::string(narrow.data(), length) == text, "narrow_ascii copy", length, length);
+
+    //the run stops at the first byte with its top bit set and the unit at or above 0x80
+    for (size_t position : test_positions(length))
+    {
+      std::string stopped = text;
+      stopped[position] = (char)0xC3;
+      std::u16string stopped_units = units;
+      stopped_units[position] = (char16_t)(random_engine() % 2 ? 0x80 : 0xFF00);
+      size_t widened = utf_simd::widen_ascii(stopped.data(), length, wide16.data());
+      check(widened == position && std::u16string(wide16.data(), widened) == units.substr(0, widened), "widen_ascii utf16 stop", length, position);
+      widened = utf_simd::widen_ascii(stopped.data(), length, wide32.data());
+      check(widened == position && std::u32string(wide32.data(), widened) == std::u32string(text.begin(), text.begin() + widened), "widen_ascii utf32 stop", length, position);
+      size_t narrowed = utf_simd::narrow_ascii(stopped_units.data(), length, narrow.data());
+      check(narrowed == position && std::string(narrow.data(), narrowed) == text.substr(0, narrowed), "narrow_ascii stop", length, position);
+    }
+  }
+}
+
+static void utf8_counting_kernels()
+{
+  for (size_t length : test_lengths())
+  {
+    //utf8 with each share of ascii, arbitrary bytes since the tallies are defined for any input, then every byte a continuation or a four byte lead so each lane counter reaches its flush
+    for (uint32_t variant = 0; variant < 7; ++variant)
+    {
+      std::string text = variant < 4 ? random_utf8(length, variant) : std::string(length, variant == 5 ? '\xBF' : '\xF4');
+      if (variant == 4)
+        for (char &byte : text)
+          byte = (char)random_engine();
+
+      size_t continuations = 0, four_byte_leads = 0, characters = 0;
+      for (char byte : text)
+      {
+        continuations += ((uint8_t)byte & 0xC0) == 0x80;
+        four_byte_leads += (uint8_t)byte >= 0xF0;
+      }
+      size_t simd_continuations, simd_four_byte_leads;
+      utf_simd::count_utf8(text.data(), length, simd_continuations, simd_four_byte_leads);
+      check(simd_continuations == continuations && simd_four_byte_leads == four_byte_leads, "count_utf8", length, variant);
+
+      //every character start, then one past the last
+      size_t chars = length - continuations;
+      for (size_t i = 0; i <= length; ++i)
+      {
+        if (i < length && ((uint8_t)text[i] & 0xC0) == 0x80)
+          continue;
+        if (characters < 40 || characters + 40 > chars || characters % 97 == 0)
+          check(utf_simd::skip_utf8(text.data(), length, characters) == i, "skip_utf8", length, characters);
+        ++characters;
+      }
+      check(utf_simd::skip_utf8(text.data(), length, chars + 5) == length, "skip_utf8 past the end", length, chars + 5);
+    }
+  }
+}
+
+static void utf16_utf32_counting_kernels()
+{
+  for (size_t length : test_lengths())
+  {
+    //surrogates are common here so pairs straddle every lane boundary, unpaired halves included, then runs of only three byte units and only pairs
+    size_t utf8_extra, simd_utf8_extra;
+    for (uint32_t variant = 0; variant < 3; ++variant)
+    {
+      std::u16string units(length, 0);
+      for (size_t i = 0; i < length; ++i)
+      {
+        if (variant == 1)
+          units[i] = 0xFFFF;
+        else if (variant == 2)
+          units[i] = i % 2 == 0 ? 0xDBFF : 0xDFFF;
+        else
+        {
+          switch (random_engine() % 5)
+          {
+          case 0: units[i] = (char16_t)(random_engine() % 0x80); break;
+          case 1: units[i] = (char16_t)(0x80 + random_engine() % 0x780); break;
+          case 2: units[i] = (char16_t)(0x800 + random_engine() % 0xF800); break;
+          case 3: units[i] = (char16_t)(0xD800 + random_engine() % 0x400); break;
+          default: units[i] = (char16_t)(0xDC00 + random_engine() % 0x400); break;
+          }
+        }
+      }
+      size_t pairs = 0;
+      utf8_extra = 0;
+      for (size_t i = 0; i < length; ++i)
+      {
+        utf8_extra += (units[i] >= 0x80) + (units[i] >= 0x800);
+        if ((units[i] & 0xFC00) == 0xD800 && i + 1 < length && (units[i + 1] & 0xFC00) == 0xDC00)
+        {
+          utf8_extra -= 2;
+          ++pairs;
+        }
+      }
+      size_t simd_pairs;
+      utf_simd::count_utf16(units.data(), length, simd_utf8_extra, simd_pairs);
+      check(simd_utf8_extra == utf8_extra && simd_pairs == pairs, "count_utf16", length, variant);
+    }
+
+    //code points past 0x10FFFF count as a three byte replacement character
+    std::u32string code_points(length, 0);
+    for (char32_t &code_point : code_points)
+      code_point = random_engine() % 8 == 0 ? (char32_t)random_engine() : random_code_point(1);
+    size_t utf16_extra = 0;
+    utf8_extra = 0;
+    for (char32_t code_point : code_points)
+    {
+      utf8_extra += code_point > 0x10FFFF ? 2 : (code_point >= 0x80) + (code_point >= 0x800) + (code_point >= 0x10000);
+      utf16_extra += code_point >= 0x10000;
+    }
+    size_t simd_utf16_extra;
+    utf_simd::count_utf32(code_points.data(), length, simd_utf8_extra, simd_utf16_extra);
+    check(simd_utf8_extra == utf8_extra && simd_utf16_extra == utf16_extra, "count_utf32", length, 0);
+  }
+}
+
+//each one is malformed wherever it lands, the comments give the rule it breaks
+static const std::vector<std::string> malformed_utf8 = {
+  "\x80",              //a continuation with no lead
+  "\xBF\x80",
+  "\xC0\x80",          //overlong two byte forms
+  "\xC1\xBF",
+  "\xE0\x80\x80",      //overlong three byte forms
+  "\xE0\x9F\xBF",
+  "\xF0\x80\x80\x80",  //overlong four byte forms
+  "\xF0\x8F\xBF\xBF",
+  "\xED\xA0\x80",      //surrogates
+  "\xED\xBF\xBF",
+  "\xF4\x90\x80\x80",  //past 0x10FFFF
+  "\xF5\x80\x80\x80",
+  "\xFF",
+  "\xC3" "a",          //a lead cut short by ascii
+  "\xE2\x82" "a",
+  "\xF0\x9F\x98" "a",
+  "\xC3\xA9\x80",      //one continuation too many
+  "\xE2\x82\xAC\x80\x80",
+};
+
+static void validate_kernels()
+{
+  for (size_t length : test_lengths())
+  {
+    for (uint32_t ascii_odds = 1; ascii_odds <= 4; ascii_odds += 3)
+    {
+      std::string text = random_utf8(length, ascii_odds);
+      check(utf_simd::validate_utf8(text.data(), length) == length, "validate_utf8 valid", length, length);
+
+      for (size_t position : test_positions(length))
+      {
+        //a malformed sequence written over the text, then the bytes it broke are left for the validator to find
+        for (const std::string &bad : malformed_utf8)
+        {
+          std::string broken = text;
+          broken.replace(position, std::min(bad.size(), length - position), bad.substr(0, length - position));
+          check(utf_simd::validate_utf8(broken.data(), length) == validate_utf8_reference(broken), "validate_utf8 malformed", length, position);
+        }
+
+        //a multi byte sequence cut off by the end of the input
+        std::string truncated = text.substr(0, position) + "\xF0\x9F\x98\x80";
+        for (size_t cut = position + 1; cut < truncated.size(); ++cut)
+          check(utf_simd::validate_utf8(truncated.data(), cut) == validate_utf8_reference(truncated.substr(0, cut)), "validate_utf8 truncated", cut, position);
+      }
+    }
+
+    std::u16string units(length, 0);
+    for (size_t i = 0; i < length; ++i)
+    {
+      units[i] = (char16_t)(random_engine() % 0xD000);
+      if (i + 1 < length && random_engine() % 4 == 0)
+      {
+        units[i] = (char16_t)(0xD800 + random_engine() % 0x400);
+        units[++i] = (char16_t)(0xDC00 + random_engine() % 0x400);
+      }
+    }
+    check(utf_simd::validate_utf16(units.data(), length) == length, "validate_utf16 valid", length, length);
+    for (size_t position : test_positions(length))
+    {
+      std::u16string broken = units;
+      broken[position] = (char16_t)(random_engine() % 2 ? 0xD800 : 0xDFFF);
+      check(utf_simd::validate_utf16(broken.data(), length) == validate_utf16_reference(broken), "validate_utf16 surrogate", length, position);
+    }
+  }
+}
+
+static const char *dispatch_tier()
+{
+  const cpu_features &features = get_cpu_features();
+  return features.avx2 ? "avx2" : features.ssse3 ? "ssse3" : features.sse2 ? "sse2" : "scalar";
+}
+
+int main()
+{
+  ascii_kernels();
+  utf8_counting_kernels();
+  utf16_utf32_counting_kernels();
+  validate_kernels();
+  if (failures == 0)
+    std::printf("utf_simd_test passed on the %s kernels\n", dispatch_tier());
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#include "parallel_job.h"
+
+namespace small_tl::threading
+{
+	parallel_job::parallel_job(size_t chunk_count, const chunk_function &function) :
+		my_function(function), my_chunk_count(chunk_count), my_next_chunk(0), my_completed_count(0)
+	{}
+
+	void parallel_job::run_chunks()
+	{
+		size_t completed = 0;
+		for (size_t chunk = my_next_chunk++; chunk < my_chunk_count; chunk = my_next_chunk++)
+		{
+			my_function(chunk);
+			++completed;
+		}
+
+		//threads that arrive after the last chunk was claimed have nothing to report
+		if (completed == 0)
+			return;
+
+		std::lock_guard<std::mutex> completed_lock(my_completed_mutex);
+		my_completed_count += completed;
+		if (my_completed_count == my_chunk_count)
+			my_completed_event.notify_all();
+	}
+
+	void parallel_job::wait()
+	{
+		std::unique_lock<std::mutex> completed_lock(my_completed_mutex);
+		my_completed_event.wait(completed_lock, [this]()->bool {return my_completed_count == my_chunk_count; });
+	}
+}
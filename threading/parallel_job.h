@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace small_tl::threading
+{
+	//a data parallel task split into numbered chunks, any number of threads can claim and run chunks until none are left
+	class parallel_job
+	{
+		parallel_job(const parallel_job &) = delete;
+		parallel_job(parallel_job &&) = delete;
+		parallel_job& operator=(const parallel_job &) = delete;
+		parallel_job& operator=(parallel_job &&) = delete;
+
+	public:
+		typedef std::function<void(size_t chunk)> chunk_function;
+
+		parallel_job(size_t chunk_count, const chunk_function &function);
+
+		//claims and runs chunks until every chunk has been claimed
+		void run_chunks();
+
+		//blocks until every chunk has finished running
+		void wait();
+
+	private:
+		const chunk_function my_function;
+		const size_t my_chunk_count;
+		std::atomic<size_t> my_next_chunk;
+
+		std::mutex my_completed_mutex;
+		size_t my_completed_count;
+		std::condition_variable my_completed_event;
+	};
+}
@@ -0,0 +1,27 @@
+#include "parallel_worker.h"
+
+namespace small_tl::threading
+{
+	parallel_worker::parallel_worker(const std::string &name) : worker(name) {}
+
+	void parallel_worker::post(const std::shared_ptr<parallel_job> &job)
+	{
+		{
+			std::lock_guard<std::mutex> jobs_lock(my_jobs_mutex);
+			my_jobs.push_back(job);
+		}
+		schedule_work();
+	}
+
+	void parallel_worker::run()
+	{
+		std::vector<std::shared_ptr<parallel_job>> thread_local_jobs;
+		{
+			std::lock_guard<std::mutex> jobs_lock(my_jobs_mutex);
+			thread_local_jobs.swap(my_jobs);
+		}
+
+		for (std::shared_ptr<parallel_job> &job : thread_local_jobs)
+			job->run_chunks();
+	}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "worker.h"
+#include "parallel_job.h"
+
+namespace small_tl::threading
+{
+	//a worker that helps run the chunks of parallel_jobs posted to it, a worker_thread_pool keeps one on each of its threads
+	class parallel_worker : public worker
+	{
+	public:
+		parallel_worker(const std::string &name);
+
+		void post(const std::shared_ptr<parallel_job> &job);
+
+	private:
+		// Inherited via Worker
+		virtual void run() override;
+
+		std::mutex my_jobs_mutex;
+		std::vector<std::shared_ptr<parallel_job>> my_jobs;
+	};
+}
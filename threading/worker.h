@@ -1,6 +1,8 @@
 #pragma once
 #include <memory>
 #include <mutex>
+#include <string>
+#include "worker_types.h"
 
 namespace small_tl::threading
 {
@@ -12,7 +12,7 @@ namespace small_tl::threading
 		my_add_thread_index = my_worker_threads.begin();
 	}
 
-	void worker_thread_pool::add_worker(shared_worker &worker)
+	void worker_thread_pool::add_worker(const shared_worker &worker)
 	{
 
 		worker_thread *worker_thread = nullptr;
@@ -22,8 +22,41 @@ namespace small_tl::threading
 			if (my_add_thread_index == my_worker_threads.end())
 				my_add_thread_index = my_worker_threads.begin();
 		}
+		add_worker(worker, worker_thread);
+	}
+
+	void worker_thread_pool::add_worker(const shared_worker &worker, worker_thread *worker_thread)
+	{
 		worker->set_worker_thread(worker_thread);
 		worker_thread->add_worker(worker);
+	}
+
+	void worker_thread_pool::run_parallel(size_t chunk_count, const std::function<void(size_t chunk)> &chunk)
+	{
+		if (chunk_count == 0)
+			return;
+
+		std::shared_ptr<parallel_job> job = std::make_shared<parallel_job>(chunk_count, chunk);
+		if (chunk_count > 1)
+		{
+			std::lock_guard<std::mutex> parallel_workers_lock(my_parallel_workers_mutex);
+			//one parallel worker pinned to each thread, created the first time they are needed
+			if (my_parallel_workers.empty())
+			{
+				for (std::unique_ptr<worker_thread> &worker_thread : my_worker_threads)
+				{
+					my_parallel_workers.emplace_back(new parallel_worker(my_name + " parallel"));
+					add_worker(my_parallel_workers.back(), worker_thread.get());
+				}
+			}
+
+			//the calling thread takes one share of the chunks itself
+			size_t helpers = std::min(my_parallel_workers.size(), chunk_count - 1);
+			for (size_t i = 0; i < helpers; ++i)
+				my_parallel_workers[i]->post(job);
+		}
 
+		job->run_chunks();
+		job->wait();
 	}
 }
\ No newline at end of file
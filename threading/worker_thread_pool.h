@@ -3,11 +3,13 @@
 #include <list>
 #include <thread>
 #include <algorithm>
+#include <functional>
 #include "worker_thread.h"
 #include "worker_types.h"
+#include "parallel_worker.h"
 
 //oversubscribe potentially quiet threads
-uint8_t default_thread_pool_size = std::min<uint8_t>(8, std::thread::hardware_concurrency() * 2);
+inline uint8_t default_thread_pool_size = std::min<uint8_t>(8, std::thread::hardware_concurrency() * 2);
 
 namespace small_tl::threading
 {
@@ -24,14 +26,25 @@ namespace small_tl::threading
 			add_worker(std::static_pointer_cast<worker, worker_type>(worker));
 			return worker;
 		}
+
+		size_t thread_count() const { return my_worker_threads.size(); }
+
+		//runs chunk(0) to chunk(chunk_count - 1) across every thread in the pool
+		//the calling thread runs chunks too and returns once they have all completed
+		void run_parallel(size_t chunk_count, const std::function<void(size_t chunk)> &chunk);
+
 	private:
 		typedef std::vector<std::unique_ptr<worker_thread>> worker_threads;
 
-		void add_worker(shared_worker &worker);
+		void add_worker(const shared_worker &worker);
+		void add_worker(const shared_worker &worker, worker_thread *worker_thread);
 
 		const std::string my_name;
 		std::mutex my_add_mutex;
 		worker_threads::iterator my_add_thread_index;
 		worker_threads my_worker_threads;
+
+		std::mutex my_parallel_workers_mutex;
+		std::vector<std::shared_ptr<parallel_worker>> my_parallel_workers;
 	};
 }
\ No newline at end of file
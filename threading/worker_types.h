@@ -3,6 +3,7 @@
 #include <set>
 #include <map>
 #include <stack>
+#include <vector>
 #include <cstdint>
 
 namespace small_tl::threading
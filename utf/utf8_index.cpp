@@ -0,0 +1,66 @@
+#include "utf8_index.h"
+#include "utf_simd.h"
+#include <algorithm>
+#include <cassert>
+
+namespace small_tl::utf_convert
+{
+  utf8_index::utf8_index() noexcept : m_src(nullptr), m_count(0), m_size(0), m_stride(default_stride) {}
+
+  utf8_index::utf8_index(const char *src, size_t count, size_t stride) : utf8_index()
+  {
+    build(src, count, stride);
+  }
+
+  void utf8_index::build(const char *src, size_t count, size_t stride)
+  {
+    assert(stride != 0);
+    size_t continuations, four_byte_leads;
+    simd::count_utf8(src, count, continuations, four_byte_leads);
+    m_src = src;
+    m_count = count;
+    m_size = count - continuations;
+    m_stride = stride;
+
+    m_samples.resize(m_size / stride + 1);
+    size_t offset = simd::skip_utf8(src, count, 0);
+    m_samples[0] = offset;
+    for (size_t sample = 1; sample < m_samples.size(); ++sample)
+    {
+      offset += simd::skip_utf8(src + offset, count - offset, stride);
+      m_samples[sample] = offset;
+    }
+  }
+
+  size_t utf8_index::byte_offset(size_t n) const noexcept
+  {
+    assert(n <= m_size);
+    size_t offset = m_samples[n / m_stride];
+    return offset + simd::skip_utf8(m_src + offset, m_count - offset, n % m_stride);
+  }
+
+  size_t utf8_index::char_offset(size_t byte) const noexcept
+  {
+    assert(byte <= m_count);
+    //the last sample at or before byte, continuation bytes ahead of the first code point belong to none
+    std::vector<size_t>::const_iterator after = std::upper_bound(m_samples.cbegin(), m_samples.cend(), byte);
+    if (after == m_samples.cbegin())
+      return 0;
+    size_t sample = after - m_samples.cbegin() - 1;
+    size_t offset = m_samples[sample];
+
+    size_t continuations, four_byte_leads;
+    simd::count_utf8(m_src + offset, byte - offset, continuations, four_byte_leads);
+    return sample * m_stride + (byte - offset - continuations);
+  }
+
+  std::string_view utf8_index::substr(size_t pos, size_t n) const noexcept
+  {
+    assert(pos <= m_size);
+    n = std::min(n, m_size - pos);
+    size_t first = byte_offset(pos);
+    //a short substring is found by scanning on from its start rather than from a sample
+    size_t last = n <= m_stride ? first + simd::skip_utf8(m_src + first, m_count - first, n) : byte_offset(pos + n);
+    return std::string_view(m_src + first, last - first);
+  }
+}
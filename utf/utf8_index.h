@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace small_tl::utf_convert
+{
+  //random access by code point into a utf8 buffer it does not own, the buffer must outlive the index and stay unchanged
+  //the byte offset of every stride-th code point is sampled, so any code point is reached by scanning at most stride of them with the simd kernels
+  //a code point starts at every byte that is not a continuation byte, so the counts are exact for well formed utf8
+  class utf8_index
+  {
+  public:
+    static constexpr size_t default_stride = 256;
+    static constexpr size_t npos = size_t(-1);
+
+    utf8_index() noexcept;
+    utf8_index(const char *src, size_t count, size_t stride = default_stride);
+    explicit utf8_index(std::string_view src, size_t stride = default_stride) : utf8_index(src.data(), src.size(), stride) {}
+
+    //indexes count bytes of src in two simd passes, replacing anything indexed before
+    void build(const char *src, size_t count, size_t stride = default_stride);
+
+    //code points in the buffer
+    size_t size() const noexcept { return m_size; }
+
+    const char *data() const noexcept { return m_src; }
+    size_t byte_size() const noexcept { return m_count; }
+
+    //byte offset of code point n, the end of the buffer when n is size(), in constant time
+    size_t byte_offset(size_t n) const noexcept;
+
+    //code points that start before byte, which is the index of the one starting at byte, in logarithmic time
+    size_t char_offset(size_t byte) const noexcept;
+
+    //up to n code points starting at code point pos, pos must not be past size()
+    std::string_view substr(size_t pos, size_t n = npos) const noexcept;
+
+  private:
+    const char *m_src;
+    size_t m_count;
+    size_t m_size;
+    size_t m_stride;
+    //byte offsets of code points 0, stride, 2 * stride and so on up to size()
+    std::vector<size_t> m_samples;
+  };
+}
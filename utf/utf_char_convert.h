@@ -1,4 +1,9 @@
 #pragma once
+#include <string>
+#include <cstdint>
+
+#include "utf_helpers.h"
+
 namespace small_tl::utf_convert
 {
   //
@@ -9,85 +14,103 @@ namespace small_tl::utf_convert
 
   void to_utf16_char(char32_t src_char, std::u16string &dst);
 
+  //the same encodings written to a buffer with room for a whole character, return the units written
+  constexpr uint8_t to_utf8_char(char32_t src_char, char *dst)
+  {
+    if (src_char <= 0x7F)
+    {
+      dst[0] = (char)src_char;
+      return 1;
+    }
+    if (src_char <= 0x7FF)
+    {
+      dst[0] = (char)(0xC0 | (src_char >> 6));
+      dst[1] = (char)(0x80 | (src_char & 0x3F));
+      return 2;
+    }
+    if (src_char <= 0xFFFF)
+    {
+      dst[0] = (char)(0xE0 | (src_char >> 12));
+      dst[1] = (char)(0x80 | ((src_char >> 6) & 0x3F));
+      dst[2] = (char)(0x80 | (src_char & 0x3F));
+      return 3;
+    }
+    if (src_char <= 0x10FFFF)
+    {
+      dst[0] = (char)(0xF0 | (src_char >> 18));
+      dst[1] = (char)(0x80 | ((src_char >> 12) & 0x3F));
+      dst[2] = (char)(0x80 | ((src_char >> 6) & 0x3F));
+      dst[3] = (char)(0x80 | (src_char & 0x3F));
+      return 4;
+    }
+    return to_utf8_char(0xFFFD, dst);
+  }
+
+  constexpr uint8_t to_utf16_char(char32_t src_char, char16_t *dst)
+  {
+    if (src_char <= 0xFFFF)
+    {
+      dst[0] = (char16_t)src_char;
+      return 1;
+    }
+    src_char -= 0x10000;
+    dst[0] = (char16_t)(((src_char >> 10) & 0x3FF) + 0xD800);
+    dst[1] = (char16_t)((src_char & 0x3FF) + 0xDC00);
+    return 2;
+  }
+
   //unsupported src type
   template<class src_char_t, typename std::enable_if<!std::is_integral<src_char_t>::value, src_char_t>::type * = nullptr>
-  int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result) { static_assert(false, "src_char_t must be an integral type"); }
+  int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result) { static_assert(dependent_false<src_char_t>::value, "src_char_t must be an integral type"); return 0; }
   template<class src_char_t, typename std::enable_if<std::is_integral<src_char_t>::value && (sizeof(src_char_t) > 2), src_char_t>::type * = nullptr>
-  int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result) { static_assert(false, "src_char_t must 8 or 16 bit"); }
+  int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result) { static_assert(dependent_false<src_char_t>::value, "src_char_t must 8 or 16 bit"); return 0; }
 
   //typed utf8 inflate, -1 indicates it could only read a single character but that that character implied it was part of a sequence
+  //runs the utf8_dfa, so overlong forms, surrogates, code points past 0x10FFFF, bad leads and stray continuations all give -1
   template<class src_char_t, typename std::enable_if<std::is_integral<src_char_t>::value && sizeof(src_char_t) == 1, src_char_t>::type * = nullptr>
-  int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result)
+  constexpr int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result)
   {
-    result = 0;
-    uint8_t bytes = bytes_in_utf8_sequence(*src_char);
-    uint8_t position = 0;
-    switch (bytes)
+    uint8_t state = utf8_accept;
+    char32_t code_point = 0;
+    for (uint8_t chars_read = 0; chars_read < max_src_char_count;)
     {
-    case 1:
-      result = (uint8_t)(*src_char);
-      break;
-    case 2:
-      position = 6;
-      result = (((uint8_t)*src_char) & 0x1F) << position;
-      break;
-    case 3:
-      position = 12;
-      result = (((uint8_t)*src_char) & 0x0F) << position;
-      break;
-    case 4:
-      position = 18;
-      result = (((uint8_t)*src_char) & 0x07) << position;
-      break;
-    }
-
-    int8_t chars_read = 1;
-    while (position > 0)
-    {
-      src_char_t const * next_char = src_char + chars_read;
-      if (chars_read >= max_src_char_count || ((*next_char & 0xC0) != 0x80))
+      uint8_t byte = (uint8_t)src_char[chars_read++];
+      uint8_t type = utf8_dfa[byte];
+      code_point = state != utf8_accept ? (byte & 0x3Fu) | (code_point << 6) : (0xFFu >> type) & byte;
+      state = utf8_dfa[256 + state + type];
+      if (state == utf8_accept)
       {
-        result = (uint8_t)(*src_char);
-        return -1;//sequence error
+        result = code_point;
+        return chars_read;
       }
-
-      ++chars_read;
-      position -= 6;
-      result |= (((uint8_t)*next_char) & 0x3F) << position;
+      if (state == utf8_reject)
+        break;
     }
-    return chars_read;
+    result = (uint8_t)(*src_char);
+    return -1;//sequence error
   }
 
   //typed utf16 inflate, -1 indicates it could only read a single character but that that character implied it was part of a sequence
   template<class src_char_t, typename std::enable_if<std::is_integral<src_char_t>::value && sizeof(src_char_t) == 2, src_char_t>::type * = nullptr>
-  int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result)
+  constexpr int8_t to_utf32_char(src_char_t const * const src_char, uint8_t max_src_char_count, char32_t &result)
   {
-    result = *src_char;
+    result = (char16_t)*src_char;
     utf16_order surrogate = utf16_order_of_char(*src_char);
+    if (surrogate == SINGLE)
+      return 1;
 
-    char16_t high_surrogate, low_surrogate;
-    switch (surrogate)
-    {
-    case SINGLE:return 1;
-    case HIGH_SURROGATE:
-      high_surrogate = *src_char;
-      low_surrogate = *(src_char + 1);
-    case LOW_SURROGATE:
-      high_surrogate = *(src_char + 1);
-      low_surrogate = *src_char;
-    }
-    utf16_order other_surrogate = utf16_order_of_char(*(src_char + 1));
-    if (other_surrogate != (surrogate + 1) % 2)
-      return -1;
-    if (max_src_char_count < 2)
+    //only a high surrogate followed by a low one is a pair, anything else leaves the lone surrogate as the result
+    if (surrogate == LOW_SURROGATE || max_src_char_count < 2 || utf16_order_of_char(*(src_char + 1)) != LOW_SURROGATE)
       return -1;
+
+    char16_t high_surrogate = (char16_t)*src_char, low_surrogate = (char16_t)*(src_char + 1);
     result = 0x10000 + ((((char32_t)(high_surrogate - 0xD800) & 0x3FF) << 10) | ((low_surrogate - 0xDC00) & 0x3FF));
     return 2;
   }
 
   //unsupported raw type
   template<uint8_t bytes_in_base_type>
-  char32_t to_utf32_char(char const * const src_char, uint8_t src_char_count) { static_assert(false, "unsupported conversion to utf32"); }
+  char32_t to_utf32_char(char const * const src_char, uint8_t src_char_count) { static_assert(bytes_in_base_type != bytes_in_base_type, "unsupported conversion to utf32"); return 0; }
 
   //utf8 inflate from raw chars
   template<> char32_t to_utf32_char<1>(char const * const src_char, uint8_t src_char_count);
@@ -1,37 +1,8 @@
 #include "utf_convert.h"
+#include "utf_simd.h"
 
 namespace small_tl::utf_convert
 {
-
-  //
-  //helpers
-  //
-
-  utf16_order utf16_order_of_char(char16_t character)
-  {
-    if (character >= 0xD800)
-    {
-      if (character <= 0xDBFF)
-        return HIGH_SURROGATE;
-      else if (character <= 0xDFFF)
-        return LOW_SURROGATE;
-    }
-    return SINGLE;
-  }
-
-  //helper to count the bytes in a sequence
-  uint8_t bytes_in_utf8_sequence(char character)
-  {
-    uint8_t bytes_in_utf8_sequence = 0;
-    for (uint8_t mask_location = 7; mask_location >= 5; --mask_location, ++bytes_in_utf8_sequence)
-    {
-      uint8_t mask = 1 << mask_location;
-      uint8_t masked = mask & character;
-      if (masked == 0)return std::max<uint8_t>(bytes_in_utf8_sequence, 1);
-    }
-    return bytes_in_utf8_sequence;
-  }
-
   //
   //characters
   //
@@ -116,4 +87,218 @@ namespace small_tl::utf_convert
       return big_char;
     }
   }
-}
\ No newline at end of file
+
+  //
+  //raw buffers
+  //
+
+  size_t utf8_to_utf32(const char *src, size_t count, char32_t *dst)
+  {
+    const char *end = src + count;
+    char32_t *dst_char = dst;
+    while (src != end)
+    {
+      size_t ascii = simd::widen_ascii(src, end - src, dst_char);
+      src += ascii;
+      dst_char += ascii;
+
+      //multibyte characters are decoded one at a time until the next ascii byte
+      while (src != end && (uint8_t)*src >= 0x80)
+      {
+        int8_t chars_read = to_utf32_char(src, (uint8_t)std::min<size_t>(end - src, 4), *dst_char++);
+        src += chars_read >= 1 ? chars_read : 1;
+      }
+    }
+    return dst_char - dst;
+  }
+
+  size_t utf8_to_utf16(const char *src, size_t count, char16_t *dst)
+  {
+    const char *end = src + count;
+    char16_t *dst_char = dst;
+    while (src != end)
+    {
+      size_t ascii = simd::widen_ascii(src, end - src, dst_char);
+      src += ascii;
+      dst_char += ascii;
+
+      while (src != end && (uint8_t)*src >= 0x80)
+      {
+        char32_t code_point;
+        int8_t chars_read = to_utf32_char(src, (uint8_t)std::min<size_t>(end - src, 4), code_point);
+        src += chars_read >= 1 ? chars_read : 1;
+        dst_char += to_utf16_char(code_point, dst_char);
+      }
+    }
+    return dst_char - dst;
+  }
+
+  size_t utf16_to_utf8(const char16_t *src, size_t count, char *dst)
+  {
+    const char16_t *end = src + count;
+    char *dst_char = dst;
+    while (src != end)
+    {
+      size_t ascii = simd::narrow_ascii(src, end - src, dst_char);
+      src += ascii;
+      dst_char += ascii;
+
+      while (src != end && *src >= 0x80)
+      {
+        char32_t code_point;
+        int8_t chars_read = to_utf32_char(src, (uint8_t)std::min<size_t>(end - src, 2), code_point);
+        src += chars_read >= 1 ? chars_read : 1;
+        dst_char += to_utf8_char(code_point, dst_char);
+      }
+    }
+    return dst_char - dst;
+  }
+
+  size_t utf32_to_utf8(const char32_t *src, size_t count, char *dst)
+  {
+    char *dst_char = dst;
+    for (size_t i = 0; i < count; ++i)
+      dst_char += to_utf8_char(src[i], dst_char);
+    return dst_char - dst;
+  }
+
+  size_t utf32_to_utf16(const char32_t *src, size_t count, char16_t *dst)
+  {
+    char16_t *dst_char = dst;
+    for (size_t i = 0; i < count; ++i)
+      dst_char += to_utf16_char(src[i], dst_char);
+    return dst_char - dst;
+  }
+
+  //
+  //validation
+  //
+
+  size_t validate_utf8(const char *src, size_t count)
+  {
+    return simd::validate_utf8(src, count);
+  }
+
+  size_t validate_utf16(const char16_t *src, size_t count)
+  {
+    return simd::validate_utf16(src, count);
+  }
+
+  //decodes a well formed multibyte sequence, returns its length
+  static inline size_t decode_valid_utf8(const char *src, char32_t &code_point)
+  {
+    uint8_t lead = (uint8_t)src[0];
+    if (lead < 0xE0)
+    {
+      code_point = ((char32_t)(lead & 0x1F) << 6) | ((uint8_t)src[1] & 0x3F);
+      return 2;
+    }
+    if (lead < 0xF0)
+    {
+      code_point = ((char32_t)(lead & 0x0F) << 12) | ((char32_t)((uint8_t)src[1] & 0x3F) << 6) | ((uint8_t)src[2] & 0x3F);
+      return 3;
+    }
+    code_point = ((char32_t)(lead & 0x07) << 18) | ((char32_t)((uint8_t)src[1] & 0x3F) << 12) | ((char32_t)((uint8_t)src[2] & 0x3F) << 6) | ((uint8_t)src[3] & 0x3F);
+    return 4;
+  }
+
+  size_t valid_utf8_to_utf32(const char *src, size_t count, char32_t *dst)
+  {
+    const char *end = src + count;
+    char32_t *dst_char = dst;
+    while (src != end)
+    {
+      size_t ascii = simd::widen_ascii(src, end - src, dst_char);
+      src += ascii;
+      dst_char += ascii;
+      while (src != end && (uint8_t)*src >= 0x80)
+        src += decode_valid_utf8(src, *dst_char++);
+    }
+    return dst_char - dst;
+  }
+
+  size_t valid_utf8_to_utf16(const char *src, size_t count, char16_t *dst)
+  {
+    const char *end = src + count;
+    char16_t *dst_char = dst;
+    while (src != end)
+    {
+      size_t ascii = simd::widen_ascii(src, end - src, dst_char);
+      src += ascii;
+      dst_char += ascii;
+      while (src != end && (uint8_t)*src >= 0x80)
+      {
+        char32_t code_point;
+        src += decode_valid_utf8(src, code_point);
+        dst_char += to_utf16_char(code_point, dst_char);
+      }
+    }
+    return dst_char - dst;
+  }
+
+  size_t valid_utf16_to_utf8(const char16_t *src, size_t count, char *dst)
+  {
+    const char16_t *end = src + count;
+    char *dst_char = dst;
+    while (src != end)
+    {
+      size_t ascii = simd::narrow_ascii(src, end - src, dst_char);
+      src += ascii;
+      dst_char += ascii;
+      while (src != end && *src >= 0x80)
+      {
+        char32_t code_point = *src++;
+        if (code_point >= 0xD800 && code_point <= 0xDBFF)
+          code_point = 0x10000 + ((code_point - 0xD800) << 10) + (*src++ - 0xDC00);
+        dst_char += to_utf8_char(code_point, dst_char);
+      }
+    }
+    return dst_char - dst;
+  }
+
+  //
+  //lengths
+  //
+
+  size_t utf8_length_from_utf16(const char16_t *src, size_t count)
+  {
+    size_t utf8_extra, pairs;
+    simd::count_utf16(src, count, utf8_extra, pairs);
+    return count + utf8_extra;
+  }
+
+  size_t utf32_length_from_utf16(const char16_t *src, size_t count)
+  {
+    size_t utf8_extra, pairs;
+    simd::count_utf16(src, count, utf8_extra, pairs);
+    return count - pairs;
+  }
+
+  size_t utf8_length_from_utf32(const char32_t *src, size_t count)
+  {
+    size_t utf8_extra, utf16_extra;
+    simd::count_utf32(src, count, utf8_extra, utf16_extra);
+    return count + utf8_extra;
+  }
+
+  size_t utf16_length_from_utf32(const char32_t *src, size_t count)
+  {
+    size_t utf8_extra, utf16_extra;
+    simd::count_utf32(src, count, utf8_extra, utf16_extra);
+    return count + utf16_extra;
+  }
+
+  size_t utf16_length_from_utf8(const char *src, size_t count)
+  {
+    size_t continuations, four_byte_leads;
+    simd::count_utf8(src, count, continuations, four_byte_leads);
+    return count - continuations + four_byte_leads;
+  }
+
+  size_t utf32_length_from_utf8(const char *src, size_t count)
+  {
+    size_t continuations, four_byte_leads;
+    simd::count_utf8(src, count, continuations, four_byte_leads);
+    return count - continuations;
+  }
+}
@@ -2,6 +2,7 @@
 #include <string>
 #include <type_traits>
 #include <algorithm>
+#include <cassert>
 
 #include "utf_helpers.h"
 #include "utf_char_convert.h"
@@ -9,22 +10,112 @@
 namespace small_tl::utf_convert
 {
   //
-  //utf8
+  //raw buffers
   //
 
-  //prevents calling to_utf8 with unsuitable types
+  //decodes count bytes of utf8 into dst, which must have room for count code points, returns the code points written
+  //ascii runs are widened by simd kernels, malformed sequences decode the same way to_utf32_char decodes them
+  size_t utf8_to_utf32(const char *src, size_t count, char32_t *dst);
+
+  //as utf8_to_utf32 with each code point encoded to utf16, dst must have room for count units
+  size_t utf8_to_utf16(const char *src, size_t count, char16_t *dst);
+
+  //encodes count units of utf16 straight to utf8 in one pass, dst must have room for utf8_length_from_utf16 bytes, returns the bytes written
+  //lone surrogates are encoded as they are, the same as to_utf8_char does with them
+  size_t utf16_to_utf8(const char16_t *src, size_t count, char *dst);
+
+  //encode count code points, dst must have room for utf8_length_from_utf32 or utf16_length_from_utf32 units, return the units written
+  size_t utf32_to_utf8(const char32_t *src, size_t count, char *dst);
+  size_t utf32_to_utf16(const char32_t *src, size_t count, char16_t *dst);
+
+  //
+  //validation
+  //
+
+  //offset of the lead byte of the first malformed sequence, or count when src is valid utf8
+  //overlong encodings, encoded surrogates, code points past 0x10FFFF and sequences cut off by the end are all malformed
+  //checks 16 or 32 bytes a step with ssse3 or avx2 lookup tables
+  size_t validate_utf8(const char *src, size_t count);
+
+  //offset of the first unpaired surrogate, or count when src is valid utf16
+  size_t validate_utf16(const char16_t *src, size_t count);
+
+  //as the raw buffer converters above for input that has passed validate_utf8 or validate_utf16, without checking each character
+  //malformed input gives meaningless output and can read up to three units past the end
+  size_t valid_utf8_to_utf32(const char *src, size_t count, char32_t *dst);
+  size_t valid_utf8_to_utf16(const char *src, size_t count, char16_t *dst);
+  size_t valid_utf16_to_utf8(const char16_t *src, size_t count, char *dst);
+
+  //selects the converters for validated input
+  struct assume_valid_t {};
+  constexpr assume_valid_t assume_valid{};
+
+  //
+  //lengths
+  //
+
+  //units each conversion writes for count units of src, counted with simd kernels
+  //the lengths from utf16 and utf32 are exact for any input, including lone surrogates and code points past 0x10FFFF
+  size_t utf8_length_from_utf16(const char16_t *src, size_t count);
+  size_t utf32_length_from_utf16(const char16_t *src, size_t count);
+  size_t utf8_length_from_utf32(const char32_t *src, size_t count);
+  size_t utf16_length_from_utf32(const char32_t *src, size_t count);
+
+  //the lengths from utf8 are exact for well formed input, malformed sequences decode a unit per byte and can come out longer
+  size_t utf16_length_from_utf8(const char *src, size_t count);
+  size_t utf32_length_from_utf8(const char *src, size_t count);
+
+  //
+  //utf32
+  //
+
+  //prevents calling to_utf32 with unsuitable types
   template<class src_t, typename std::enable_if<!is_integral_container<src_t>::value, src_t>::type * = nullptr>
-  std::string to_utf8(const src_t &src)
+  std::u32string to_utf32(const src_t &src)
   {
-    static_assert(false, "src_t must be an integral container");
-    return std::string();
+    static_assert(dependent_false<src_t>::value, "src_t must be an integral container");
+    return std::u32string();
   }
 
-  //converts a utf16 string stored in an iterable container to a utf8 string stored in a std::string
-  template<class src_t, typename std::enable_if<is_integral_container<src_t>::value && sizeof(typename src_t::value_type) == 2, src_t>::type * = nullptr>
+  //converts a utf8 or utf16 string stored in integral container to a utf32 string stored in a std::u32string
+  template<class src_t, typename std::enable_if<is_integral_container<src_t>::value, src_t>::type * = nullptr>
+  std::u32string to_utf32(const src_t &src)
+  {
+    std::u32string dst;
+    if constexpr (sizeof(typename src_t::value_type) == 1 && is_contiguous_container<src_t>::value)
+    {
+      dst.resize(src.size());
+      dst.resize(utf8_to_utf32((const char *)src.data(), src.size(), &dst[0]));
+      return dst;
+    }
+
+    dst.reserve(src.size());
+    char32_t dst_char;
+    for (typename src_t::const_iterator src_char = src.cbegin(); src_char != src.cend();)
+    {
+      //no sequence is longer than 4, and the count must not wrap in the uint8_t
+      uint8_t remaining = (uint8_t)std::min<size_t>(src.cend() - src_char, 4);
+      int8_t chars_read = to_utf32_char(&*src_char, remaining, dst_char);
+      if (chars_read >= 1)
+      {
+        src_char += chars_read;
+      }
+      else ++src_char;
+      dst.push_back(dst_char);
+    }
+    return dst;
+  }
+
+  //
+  //utf8
+  //
+
+  //prevents calling to_utf8 with unsuitable types
+  template<class src_t, typename std::enable_if<!is_integral_container<src_t>::value, src_t>::type * = nullptr>
   std::string to_utf8(const src_t &src)
   {
-    return to_utf8(to_utf32(src));
+    static_assert(dependent_false<src_t>::value, "src_t must be an integral container");
+    return std::string();
   }
 
   //converts a utf32 string stored in an iterable container to a utf8 string stored in a std::string
@@ -32,6 +123,14 @@ namespace small_tl::utf_convert
   std::string to_utf8(const src_t &src)
   {
     std::string dst;
+    if constexpr (is_contiguous_container<src_t>::value)
+    {
+      const char32_t *src_chars = (const char32_t *)src.data();
+      dst.resize(utf8_length_from_utf32(src_chars, src.size()));
+      utf32_to_utf8(src_chars, src.size(), &dst[0]);
+      return dst;
+    }
+
     dst.reserve(src.size() * 3);
     for (typename src_t::const_iterator src_char = src.cbegin(); src_char != src.cend(); ++src_char)
     {
@@ -41,9 +140,34 @@ namespace small_tl::utf_convert
     return dst;
   }
 
+  //converts a utf16 string stored in an iterable container to a utf8 string stored in a std::string
+  template<class src_t, typename std::enable_if<is_integral_container<src_t>::value && sizeof(typename src_t::value_type) == 2, src_t>::type * = nullptr>
+  std::string to_utf8(const src_t &src)
+  {
+    std::string dst;
+    if constexpr (is_contiguous_container<src_t>::value)
+    {
+      const char16_t *src_chars = (const char16_t *)src.data();
+      dst.resize(utf8_length_from_utf16(src_chars, src.size()));
+      utf16_to_utf8(src_chars, src.size(), &dst[0]);
+      return dst;
+    }
+
+    dst.reserve(src.size() * 3);
+    char32_t dst_char;
+    for (typename src_t::const_iterator src_char = src.cbegin(); src_char != src.cend();)
+    {
+      uint8_t remaining = (uint8_t)std::min<size_t>(src.cend() - src_char, 2);
+      int8_t chars_read = to_utf32_char(&*src_char, remaining, dst_char);
+      src_char += chars_read >= 1 ? chars_read : 1;
+      to_utf8_char(dst_char, dst);
+    }
+    return dst;
+  }
+
   //converts a utf16 or utf32 string stored in an iterable container to a utf8 string stored in a std::string, defaults to utf32
   //!!it is not a good idea to store non utf8 mutlibyte strings in a std::string as it introduces artificial null terminators and breaks c interoperability!!
-  template<class src_t, typename std::enable_if<is_integral_container<src_t>::value && sizeof(src_t::value_type) == 1, uint8_t>::type bytes_in_code_point = 4>
+  template<class src_t, typename std::enable_if<is_integral_container<src_t>::value && sizeof(typename src_t::value_type) == 1, uint8_t>::type bytes_in_code_point = 4>
   std::string to_utf8(const src_t &src)
   {
     std::string dst;
@@ -69,7 +193,7 @@ namespace small_tl::utf_convert
   template<class src_t, typename std::enable_if<!is_integral_container<src_t>::value, src_t>::type * = nullptr>
   std::u16string to_utf16(const src_t &src)
   {
-    static_assert(false, "src_t must be an integral container");
+    static_assert(dependent_false<src_t>::value, "src_t must be an integral container");
     return std::u16string();
   }
 
@@ -77,7 +201,25 @@ namespace small_tl::utf_convert
   template<class src_t, typename std::enable_if<is_integral_container<src_t>::value && sizeof(typename src_t::value_type) == 1, src_t>::type * = nullptr>
   std::u16string to_utf16(const src_t &src)
   {
-    return to_utf16(to_utf32(src));
+    std::u16string dst;
+    if constexpr (is_contiguous_container<src_t>::value)
+    {
+      //every byte makes at most one unit, so the size of the source is a tight bound
+      dst.resize(src.size());
+      dst.resize(utf8_to_utf16((const char *)src.data(), src.size(), &dst[0]));
+      return dst;
+    }
+
+    dst.reserve(src.size());
+    char32_t dst_char;
+    for (typename src_t::const_iterator src_char = src.cbegin(); src_char != src.cend();)
+    {
+      uint8_t remaining = (uint8_t)std::min<size_t>(src.cend() - src_char, 4);
+      int8_t chars_read = to_utf32_char(&*src_char, remaining, dst_char);
+      src_char += chars_read >= 1 ? chars_read : 1;
+      to_utf16_char(dst_char, dst);
+    }
+    return dst;
   }
 
   //converts a utf32 string stored in an iterable container to a utf16 string stored in a std::u16string
@@ -85,6 +227,14 @@ namespace small_tl::utf_convert
   std::u16string to_utf16(const src_t &src)
   {
     std::u16string dst;
+    if constexpr (is_contiguous_container<src_t>::value)
+    {
+      const char32_t *src_chars = (const char32_t *)src.data();
+      dst.resize(utf16_length_from_utf32(src_chars, src.size()));
+      utf32_to_utf16(src_chars, src.size(), &dst[0]);
+      return dst;
+    }
+
     dst.reserve(src.size());
     for (typename src_t::const_iterator src_char = src.cbegin(); src_char != src.cend(); ++src_char)
     {
@@ -95,34 +245,116 @@ namespace small_tl::utf_convert
   }
 
   //
-  //utf32
+  //validated input
   //
 
-  //prevents calling to_utf32 with unsuitable types
-  template<class src_t, typename std::enable_if<!is_integral_container<src_t>::value, src_t>::type * = nullptr>
-  std::u32string to_utf32(const src_t &src)
+  //converts utf8 that has passed validate_utf8, presized exactly and without per character checks
+  template<class src_t, typename std::enable_if<is_contiguous_container<src_t>::value && sizeof(typename src_t::value_type) == 1, src_t>::type * = nullptr>
+  std::u32string to_utf32(const src_t &src, assume_valid_t)
   {
-    static_assert(false, "src_t must be an integral container");
-    return std::u32string();
+    std::u32string dst;
+    dst.resize(utf32_length_from_utf8((const char *)src.data(), src.size()));
+    valid_utf8_to_utf32((const char *)src.data(), src.size(), &dst[0]);
+    return dst;
   }
 
-  //converts a utf8 or utf16 string stored in integral container to a utf32 string stored in a std::u32string
-  template<class src_t, typename std::enable_if<is_integral_container<src_t>::value, src_t>::type * = nullptr>
-  std::u32string to_utf32(const src_t &src)
+  template<class src_t, typename std::enable_if<is_contiguous_container<src_t>::value && sizeof(typename src_t::value_type) == 1, src_t>::type * = nullptr>
+  std::u16string to_utf16(const src_t &src, assume_valid_t)
   {
-    std::u32string dst;
-    dst.reserve(src.size());
-    char32_t dst_char;
-    for (src_t::const_iterator src_char = src.cbegin(); src_char != src.cend();)
+    std::u16string dst;
+    dst.resize(utf16_length_from_utf8((const char *)src.data(), src.size()));
+    valid_utf8_to_utf16((const char *)src.data(), src.size(), &dst[0]);
+    return dst;
+  }
+
+  //converts utf16 that has passed validate_utf16
+  template<class src_t, typename std::enable_if<is_contiguous_container<src_t>::value && sizeof(typename src_t::value_type) == 2, src_t>::type * = nullptr>
+  std::string to_utf8(const src_t &src, assume_valid_t)
+  {
+    std::string dst;
+    const char16_t *src_chars = (const char16_t *)src.data();
+    dst.resize(utf8_length_from_utf16(src_chars, src.size()));
+    valid_utf16_to_utf8(src_chars, src.size(), &dst[0]);
+    return dst;
+  }
+
+  //
+  //literals
+  //
+
+  //the result of converting a string literal, a null terminated array sized for the longest conversion that can be used in constant expressions
+  template<class char_t, size_t capacity>
+  struct utf_literal
+  {
+    char_t chars[capacity];
+    size_t length;
+
+    constexpr const char_t *data() const { return chars; }
+    constexpr const char_t *c_str() const { return chars; }
+    constexpr size_t size() const { return length; }
+    constexpr const char_t *begin() const { return chars; }
+    constexpr const char_t *end() const { return chars + length; }
+    constexpr char_t operator[](size_t index) const { return chars[index]; }
+
+    std::basic_string<char_t> str() const { return std::basic_string<char_t>(chars, length); }
+    operator std::basic_string<char_t>() const { return str(); }
+  };
+
+  //converts all but the null terminator of src, one character at a time so it can run at compile time
+  template<class to_t, size_t capacity, class from_t, size_t count>
+  constexpr utf_literal<to_t, capacity> convert_literal(const from_t (&src)[count])
+  {
+    utf_literal<to_t, capacity> dst{};
+    for (size_t i = 0; i + 1 < count;)
     {
-      int8_t chars_read = to_utf32_char(&*src_char, src.cend() - src_char, dst_char);
-      if (chars_read >= 1)
+      char32_t code_point = 0;
+      if constexpr (sizeof(from_t) == 4)
+        code_point = (char32_t)src[i++];
+      else
       {
-        src_char += chars_read;
+        int8_t chars_read = to_utf32_char(src + i, (uint8_t)std::min<size_t>(count - 1 - i, 4), code_point);
+        i += chars_read >= 1 ? chars_read : 1;
       }
-      else ++src_char;
-      dst.push_back(dst_char);
+
+      if constexpr (std::is_same<to_t, char>::value)
+        dst.length += to_utf8_char(code_point, dst.chars + dst.length);
+      else if constexpr (std::is_same<to_t, char16_t>::value)
+        dst.length += to_utf16_char(code_point, dst.chars + dst.length);
+      else
+        dst.chars[dst.length++] = code_point;
     }
     return dst;
   }
-}
\ No newline at end of file
+
+  //string literals convert in constant expressions, constexpr auto text = to_utf16(u8"...") costs nothing at runtime
+  //utf8 and utf16 never take more units in utf16 or utf32 than they started with, utf16 can take three bytes a unit in utf8 and utf32 four
+  template<class char_t, size_t count, typename std::enable_if<std::is_integral<char_t>::value && sizeof(char_t) == 1, char_t>::type * = nullptr>
+  constexpr utf_literal<char16_t, count> to_utf16(const char_t (&src)[count])
+  {
+    return convert_literal<char16_t, count>(src);
+  }
+
+  template<class char_t, size_t count, typename std::enable_if<std::is_integral<char_t>::value && sizeof(char_t) == 4, char_t>::type * = nullptr>
+  constexpr utf_literal<char16_t, (count - 1) * 2 + 1> to_utf16(const char_t (&src)[count])
+  {
+    return convert_literal<char16_t, (count - 1) * 2 + 1>(src);
+  }
+
+  template<class char_t, size_t count, typename std::enable_if<std::is_integral<char_t>::value && (sizeof(char_t) == 1 || sizeof(char_t) == 2), char_t>::type * = nullptr>
+  constexpr utf_literal<char32_t, count> to_utf32(const char_t (&src)[count])
+  {
+    return convert_literal<char32_t, count>(src);
+  }
+
+  template<class char_t, size_t count, typename std::enable_if<std::is_integral<char_t>::value && sizeof(char_t) == 2, char_t>::type * = nullptr>
+  constexpr utf_literal<char, (count - 1) * 3 + 1> to_utf8(const char_t (&src)[count])
+  {
+    return convert_literal<char, (count - 1) * 3 + 1>(src);
+  }
+
+  template<class char_t, size_t count, typename std::enable_if<std::is_integral<char_t>::value && sizeof(char_t) == 4, char_t>::type * = nullptr>
+  constexpr utf_literal<char, (count - 1) * 4 + 1> to_utf8(const char_t (&src)[count])
+  {
+    return convert_literal<char, (count - 1) * 4 + 1>(src);
+  }
+}
@@ -0,0 +1,265 @@
+#include "utf_file.h"
+#include "utf_transcoder.h"
+#include "../mapped_file.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace small_tl::utf_convert
+{
+  //the output buffer, and the staging buffer for input that has to be byte swapped or aligned first
+  static const size_t buffer_bytes = size_t(1) << 20;
+
+  static const unsigned char utf8_bom[] = { 0xEF, 0xBB, 0xBF };
+  static const unsigned char utf16le_bom[] = { 0xFF, 0xFE };
+  static const unsigned char utf16be_bom[] = { 0xFE, 0xFF };
+  static const unsigned char utf32le_bom[] = { 0xFF, 0xFE, 0x00, 0x00 };
+  static const unsigned char utf32be_bom[] = { 0x00, 0x00, 0xFE, 0xFF };
+
+  static const unsigned char *bom_bytes(utf_encoding encoding) noexcept
+  {
+    switch (encoding)
+    {
+    case utf_encoding::utf8: return utf8_bom;
+    case utf_encoding::utf16le: return utf16le_bom;
+    case utf_encoding::utf16be: return utf16be_bom;
+    case utf_encoding::utf32le: return utf32le_bom;
+    case utf_encoding::utf32be: return utf32be_bom;
+    default: return nullptr;
+    }
+  }
+
+  size_t bom_size(utf_encoding encoding) noexcept
+  {
+    switch (encoding)
+    {
+    case utf_encoding::utf8: return sizeof(utf8_bom);
+    case utf_encoding::utf16le: case utf_encoding::utf16be: return 2;
+    case utf_encoding::utf32le: case utf_encoding::utf32be: return 4;
+    default: return 0;
+    }
+  }
+
+  static bool starts_with_bom(pod_span<const char> src, utf_encoding encoding) noexcept
+  {
+    size_t bytes = bom_size(encoding);
+    return bytes != 0 && src.size() >= bytes && memcmp(src.data(), bom_bytes(encoding), bytes) == 0;
+  }
+
+  utf_encoding encoding_from_bom(pod_span<const char> src) noexcept
+  {
+    //the utf32le mark starts with the utf16le one, so it is tried first
+    const utf_encoding candidates[] = { utf_encoding::utf8, utf_encoding::utf32le, utf_encoding::utf32be, utf_encoding::utf16le, utf_encoding::utf16be };
+    for (utf_encoding candidate : candidates)
+    {
+      if (starts_with_bom(src, candidate))
+        return candidate;
+    }
+    return utf_encoding::detect;
+  }
+
+  static size_t unit_size(utf_encoding encoding) noexcept
+  {
+    return encoding == utf_encoding::utf8 ? 1 : encoding == utf_encoding::utf16le || encoding == utf_encoding::utf16be ? 2 : 4;
+  }
+
+  //true when the encoding's byte order is not the one this machine uses
+  static bool is_swapped(utf_encoding encoding) noexcept
+  {
+    const uint16_t probe = 1;
+    bool little_endian = *(const uint8_t *)&probe == 1;
+    bool big_endian_encoding = encoding == utf_encoding::utf16be || encoding == utf_encoding::utf32be;
+    return encoding != utf_encoding::utf8 && big_endian_encoding == little_endian;
+  }
+
+  static char byte_swap(char unit) noexcept { return unit; }
+  static char16_t byte_swap(char16_t unit) noexcept { return (char16_t)((unit >> 8) | (unit << 8)); }
+  static char32_t byte_swap(char32_t unit) noexcept
+  {
+    return (unit >> 24) | ((unit >> 8) & 0xFF00) | ((unit << 8) & 0xFF0000) | (unit << 24);
+  }
+
+  //copies count units from unaligned src into dst, byte swapping them if swap is set
+  template<class unit_t>
+  static void stage_units(const char *src, size_t count, bool swap, unit_t *dst) noexcept
+  {
+    memcpy(dst, src, count * sizeof(unit_t));
+    if (swap)
+    {
+      for (size_t i = 0; i < count; ++i)
+        dst[i] = byte_swap(dst[i]);
+    }
+  }
+
+  //same unit size on both sides, so only the byte order can differ
+  template<class unit_t>
+  static bool copy_units(const char *src, size_t bytes, bool swap, const transcode_writer &write)
+  {
+    if (!swap)
+      return bytes == 0 || write(src, bytes);
+
+    std::vector<unit_t> staged(buffer_bytes / sizeof(unit_t));
+    size_t count = bytes / sizeof(unit_t);
+    for (size_t position = 0; position < count;)
+    {
+      size_t chunk = std::min(count - position, staged.size());
+      stage_units(src + position * sizeof(unit_t), chunk, true, staged.data());
+      if (!write((const char *)staged.data(), chunk * sizeof(unit_t)))
+        return false;
+      position += chunk;
+    }
+    //a unit cut off by the end is passed on as it is
+    return bytes % sizeof(unit_t) == 0 || write(src + count * sizeof(unit_t), bytes % sizeof(unit_t));
+  }
+
+  template<class from_t, class to_t>
+  static bool transcode_units(const char *src, size_t bytes, bool swap_src, bool swap_dst, const transcode_writer &write)
+  {
+    utf_transcoder<from_t, to_t> transcoder;
+    std::vector<to_t> dst(buffer_bytes / sizeof(to_t));
+    size_t used = 0;
+    auto flush = [&]()
+    {
+      if (swap_dst)
+      {
+        for (size_t i = 0; i < used; ++i)
+          dst[i] = byte_swap(dst[i]);
+      }
+      bool written = used == 0 || write((const char *)dst.data(), used * sizeof(to_t));
+      used = 0;
+      return written;
+    };
+
+    //the mapping is page aligned but a span need not be, input that can not be read in place is staged a buffer at a time
+    bool staged = swap_src || (uintptr_t)src % alignof(from_t) != 0;
+    std::vector<from_t> staging(staged ? buffer_bytes / sizeof(from_t) : 0);
+    size_t count = bytes / sizeof(from_t);
+    for (size_t position = 0; position < count;)
+    {
+      size_t chunk_count = staged ? std::min(count - position, staging.size()) : count - position;
+      const from_t *chunk = (const from_t *)(src + position * sizeof(from_t));
+      if (staged)
+      {
+        stage_units(src + position * sizeof(from_t), chunk_count, swap_src, staging.data());
+        chunk = staging.data();
+      }
+
+      //transcode only stops short when dst is full, and an empty dst always has room for a character
+      for (size_t read = 0;;)
+      {
+        transcode_result done = transcoder.transcode(chunk + read, chunk_count - read, dst.data() + used, dst.size() - used);
+        read += done.read;
+        used += done.written;
+        if (read == chunk_count)
+          break;
+        if (!flush())
+          return false;
+      }
+      position += chunk_count;
+    }
+
+    //a sequence cut off by the end of src, then a unit cut off by it
+    used += transcoder.finish(dst.data() + used, dst.size() - used);
+    if (transcoder.pending() != 0)
+    {
+      if (!flush())
+        return false;
+      used += transcoder.finish(dst.data(), dst.size());
+    }
+    if (bytes % sizeof(from_t) != 0)
+    {
+      if (dst.size() - used < 4 / sizeof(to_t) && !flush())
+        return false;
+      const char32_t replacement[] = { 0xFFFD };
+      used += convert_into(pod_span<const char32_t>(replacement), pod_span<to_t>(dst.data() + used, dst.size() - used)).written;
+    }
+    return flush();
+  }
+
+  template<class from_t>
+  static bool transcode_from(const char *src, size_t bytes, bool swap_src, utf_encoding to, const transcode_writer &write)
+  {
+    bool swap_dst = is_swapped(to);
+    size_t to_size = unit_size(to);
+    if (to_size == sizeof(from_t))
+      return copy_units<from_t>(src, bytes, swap_src != swap_dst, write);
+
+    if constexpr (sizeof(from_t) != 1)
+    {
+      if (to_size == 1)
+        return transcode_units<from_t, char>(src, bytes, swap_src, false, write);
+    }
+    if constexpr (sizeof(from_t) != 2)
+    {
+      if (to_size == 2)
+        return transcode_units<from_t, char16_t>(src, bytes, swap_src, swap_dst, write);
+    }
+    if constexpr (sizeof(from_t) != 4)
+      return transcode_units<from_t, char32_t>(src, bytes, swap_src, swap_dst, write);
+    return false;
+  }
+
+  bool transcode_bytes(pod_span<const char> src, utf_encoding from, utf_encoding to, const transcode_writer &write, bool write_bom)
+  {
+    if (to == utf_encoding::detect)
+      return false;
+    if (from == utf_encoding::detect)
+    {
+      from = encoding_from_bom(src);
+      if (from == utf_encoding::detect)
+        from = utf_encoding::utf8;
+    }
+    if (starts_with_bom(src, from))
+      src = src.subspan(bom_size(from));
+    if (write_bom && !write((const char *)bom_bytes(to), bom_size(to)))
+      return false;
+
+    bool swap_src = is_swapped(from);
+    switch (unit_size(from))
+    {
+    case 1: return transcode_from<char>(src.data(), src.size(), swap_src, to, write);
+    case 2: return transcode_from<char16_t>(src.data(), src.size(), swap_src, to, write);
+    default: return transcode_from<char32_t>(src.data(), src.size(), swap_src, to, write);
+    }
+  }
+
+#if !defined(_WIN32)
+  //write may stop short at any byte, so the call is repeated for the rest
+  static bool write_all(int fd, const char *data, size_t bytes) noexcept
+  {
+    while (bytes != 0)
+    {
+      ssize_t written = ::write(fd, data, bytes);
+      if (written < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      data += written;
+      bytes -= (size_t)written;
+    }
+    return true;
+  }
+
+  bool transcode_file(const std::string &in_path, const std::string &out_path, utf_encoding from, utf_encoding to, bool write_bom)
+  {
+    mapped_file in;
+    if (!in.open(in_path, mapped_file::read_only))
+      return false;
+    int fd = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+      return false;
+
+    pod_span<const char> src((const char *)in.data(), in.size());
+    bool converted = transcode_bytes(src, from, to, [fd](const char *data, size_t bytes) { return write_all(fd, data, bytes); }, write_bom);
+    return ::close(fd) == 0 && converted;
+  }
+#endif
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "../pod_span.h"
+
+namespace small_tl::utf_convert
+{
+  //the encodings a byte stream can hold, utf16 and utf32 in either byte order
+  enum class utf_encoding
+  {
+    detect, //from the byte order mark, utf8 when there is none
+    utf8,
+    utf16le,
+    utf16be,
+    utf32le,
+    utf32be
+  };
+
+  //the encoding a byte order mark at the start of src announces, detect when it has none
+  utf_encoding encoding_from_bom(pod_span<const char> src) noexcept;
+
+  //bytes in the byte order mark of encoding
+  size_t bom_size(utf_encoding encoding) noexcept;
+
+  //receives each filled stretch of output, returns false to stop the conversion
+  typedef std::function<bool(const char *data, size_t bytes)> transcode_writer;
+
+  //converts src from one encoding to another through a fixed 1MiB buffer, handing write each full buffer and then the rest
+  //a byte order mark matching from is stripped and write_bom puts one for to ahead of the output
+  //sequences split across staging chunks are carried over by a utf_transcoder, a unit cut off by the end of src is written as U+FFFD
+  //when both encodings are the same src is passed to write as it is, returns false if write does or to is detect
+  bool transcode_bytes(pod_span<const char> src, utf_encoding from, utf_encoding to, const transcode_writer &write, bool write_bom = false);
+
+#if !defined(_WIN32)
+  //maps in_path and writes its conversion to out_path, created or truncated, with the same large writes, posix only
+  //nothing bigger than the output buffer is held in memory whatever the size of the file
+  bool transcode_file(const std::string &in_path, const std::string &out_path, utf_encoding from, utf_encoding to, bool write_bom = false);
+#endif
+}
@@ -1,4 +1,7 @@
 #pragma once
+#include <type_traits>
+#include <utility>
+#include <cstdint>
 
 namespace small_tl::utf_convert
 {
@@ -8,10 +11,48 @@ namespace small_tl::utf_convert
 
   enum utf16_order { SINGLE = -1, HIGH_SURROGATE = 0, LOW_SURROGATE = 1 };
 
-  utf16_order utf16_order_of_char(char16_t character);
+  constexpr utf16_order utf16_order_of_char(char16_t character)
+  {
+    if (character >= 0xD800)
+    {
+      if (character <= 0xDBFF)
+        return HIGH_SURROGATE;
+      else if (character <= 0xDFFF)
+        return LOW_SURROGATE;
+    }
+    return SINGLE;
+  }
+
+  //the sequence length a utf8 byte announces indexed by its high nibble, continuation bytes count as one
+  inline constexpr uint8_t utf8_sequence_lengths[16] = { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 3, 4 };
 
   //helper to count the bytes in a utf8 sequence
-  uint8_t bytes_in_utf8_sequence(char character);
+  constexpr uint8_t bytes_in_utf8_sequence(char character)
+  {
+    return utf8_sequence_lengths[(uint8_t)character >> 4];
+  }
+
+  //hoehrmann's utf8 dfa, the first 256 entries map a byte to its class and the rest map a state plus a class to the next state
+  //the classes and states are laid out so overlong forms, surrogates, code points past 0x10FFFF and bad leads all reach utf8_reject
+  inline constexpr uint8_t utf8_accept = 0;
+  inline constexpr uint8_t utf8_reject = 12;
+  inline constexpr uint8_t utf8_dfa[256 + 108] =
+  {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    8, 8, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    10, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 4, 3, 3, 11, 6, 6, 6, 5, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8,
+
+    0, 12, 24, 36, 60, 96, 84, 12, 12, 12, 48, 72, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12,
+    12, 0, 12, 12, 12, 12, 12, 0, 12, 0, 12, 12, 12, 24, 12, 12, 12, 12, 12, 24, 12, 24, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, 12, 24, 12, 12, 12, 12, 12, 12, 12, 24, 12, 12,
+    12, 12, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12, 12, 36, 12, 12, 12, 12, 12, 36, 12, 36, 12, 12,
+    12, 36, 12, 12, 12, 12, 12, 12, 12, 12, 12, 12
+  };
 
   //helper to deduce if a type is an integral container
   template<class T, class enable = void>
@@ -25,4 +66,20 @@ namespace small_tl::utf_convert
     std::is_integral<typename T::value_type>::value
     >::type> : public std::true_type
   {};
+
+  //helper to deduce if an integral container stores its elements in one array that data() points at
+  template<class T, class enable = void>
+  class is_contiguous_container : public std::false_type {};
+
+  template<class T>
+  class is_contiguous_container<T, typename std::enable_if
+    <
+    is_integral_container<T>::value &&
+    std::is_pointer<decltype(std::declval<const T &>().data())>::value
+    >::type> : public std::true_type
+  {};
+
+  //false, but only once T is known, so a static_assert on it fires when the template is used rather than when it is parsed
+  template<class T>
+  struct dependent_false : std::false_type {};
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "utf_transcoder.h"
+#include "../pod_parallel.h"
+
+namespace small_tl::utf_convert
+{
+  namespace parallel
+  {
+    //moves a chunk boundary forward until no character straddles it, which is also where the one shot decoders would be
+    template<class from_t>
+    size_t resync(const from_t *src, size_t count, size_t position) noexcept
+    {
+      if constexpr (sizeof(from_t) == 1)
+      {
+        //a sequence has at most three continuation bytes, so three steps find either a lead or the end of one
+        for (size_t step = 0; step < 3 && position < count && ((uint8_t)src[position] & 0xC0) == 0x80; ++step)
+          ++position;
+      }
+      else if constexpr (sizeof(from_t) == 2)
+      {
+        if (position < count && utf16_order_of_char((char16_t)src[position]) == LOW_SURROGATE)
+          ++position;
+      }
+      return std::min(position, count);
+    }
+
+    //the units a character at a time decode writes, for the malformed input the simd length functions do not count exactly
+    template<class from_t, class to_t>
+    size_t decoded_length(const from_t *src, size_t count) noexcept
+    {
+      size_t length = 0;
+      char32_t code_point;
+      for (size_t i = 0; i < count;)
+      {
+        int8_t chars_read = to_utf32_char(src + i, (uint8_t)std::min<size_t>(count - i, 4), code_point);
+        i += chars_read >= 1 ? chars_read : 1;
+        if constexpr (sizeof(to_t) == 1)
+        {
+          char units[4];
+          length += to_utf8_char(code_point, units);
+        }
+        else if constexpr (sizeof(to_t) == 2)
+          length += code_point > 0xFFFF ? 2 : 1;
+        else
+          length += 1;
+      }
+      return length;
+    }
+
+    //exact output units for one chunk
+    template<class from_t, class to_t>
+    size_t converted_length(const from_t *src, size_t count) noexcept
+    {
+      if constexpr (sizeof(from_t) == 1)
+      {
+        //the utf8 lengths are only exact for well formed input, the rest is counted by decoding it
+        const char *src_chars = (const char *)src;
+        size_t valid = validate_utf8(src_chars, count);
+        size_t length = sizeof(to_t) == 2 ? utf16_length_from_utf8(src_chars, valid) : utf32_length_from_utf8(src_chars, valid);
+        return valid == count ? length : length + decoded_length<from_t, to_t>(src + valid, count - valid);
+      }
+      else if constexpr (sizeof(from_t) == 2)
+      {
+        const char16_t *src_chars = (const char16_t *)src;
+        return sizeof(to_t) == 1 ? utf8_length_from_utf16(src_chars, count) : utf32_length_from_utf16(src_chars, count);
+      }
+      else
+      {
+        const char32_t *src_chars = (const char32_t *)src;
+        return sizeof(to_t) == 1 ? utf8_length_from_utf32(src_chars, count) : utf16_length_from_utf32(src_chars, count);
+      }
+    }
+  }
+
+  //converts count units of src on every thread of pool and the calling thread, the result is the same as the one shot converters give
+  //src is cut into chunks at character boundaries, their output lengths are counted in parallel, and every chunk is then converted straight into its place in the result
+  template<class to_t, class from_t>
+  std::basic_string<to_t> parallel_convert(threading::worker_thread_pool &pool, const from_t *src, size_t count)
+  {
+    static_assert(sizeof(from_t) != sizeof(to_t), "from_t and to_t must be different encodings");
+
+    size_t chunk_size = small_tl::parallel::chunk_size<from_t>(count, pool.thread_count());
+    std::vector<size_t> bounds(1, 0);
+    while (bounds.back() != count)
+      bounds.push_back(parallel::resync(src, count, bounds.back() + std::min(chunk_size, count - bounds.back())));
+    size_t chunk_count = bounds.size() - 1;
+
+    std::vector<size_t> offsets(chunk_count + 1, 0);
+    pool.run_parallel(chunk_count, [&](size_t chunk)
+    {
+      offsets[chunk + 1] = parallel::converted_length<from_t, to_t>(src + bounds[chunk], bounds[chunk + 1] - bounds[chunk]);
+    });
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+      offsets[chunk + 1] += offsets[chunk];
+
+    std::basic_string<to_t> dst;
+    dst.resize(offsets.back());
+    pool.run_parallel(chunk_count, [&](size_t chunk)
+    {
+      pod_span<const from_t> chunk_src(src + bounds[chunk], bounds[chunk + 1] - bounds[chunk]);
+      pod_span<to_t> chunk_dst(&dst[0] + offsets[chunk], offsets[chunk + 1] - offsets[chunk]);
+      transcode_result done = convert_into(chunk_src, chunk_dst);
+      assert(done.read == chunk_src.size() && done.written == chunk_dst.size());
+      (void)done;
+    });
+    return dst;
+  }
+
+  //parallel versions of to_utf8, to_utf16 and to_utf32 for contiguous containers, worth it from a few hundred kilobytes
+  template<class src_t, typename std::enable_if<is_contiguous_container<src_t>::value && sizeof(typename src_t::value_type) != 1, src_t>::type * = nullptr>
+  std::string parallel_to_utf8(threading::worker_thread_pool &pool, const src_t &src)
+  {
+    return parallel_convert<char>(pool, src.data(), src.size());
+  }
+
+  template<class src_t, typename std::enable_if<is_contiguous_container<src_t>::value && sizeof(typename src_t::value_type) != 2, src_t>::type * = nullptr>
+  std::u16string parallel_to_utf16(threading::worker_thread_pool &pool, const src_t &src)
+  {
+    return parallel_convert<char16_t>(pool, src.data(), src.size());
+  }
+
+  template<class src_t, typename std::enable_if<is_contiguous_container<src_t>::value && sizeof(typename src_t::value_type) != 4, src_t>::type * = nullptr>
+  std::u32string parallel_to_utf32(threading::worker_thread_pool &pool, const src_t &src)
+  {
+    return parallel_convert<char32_t>(pool, src.data(), src.size());
+  }
+}
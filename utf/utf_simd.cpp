@@ -0,0 +1,768 @@
+#include "utf_simd.h"
+#include "../cpu_features.h"
+#include <algorithm>
+
+#if defined(SMALL_TL_X86)
+#include <immintrin.h>
+#endif
+
+namespace small_tl::utf_convert::simd
+{
+  //
+  //scalar
+  //
+
+  template<class dst_char_t>
+  static size_t widen_ascii_scalar(const char *src, size_t count, dst_char_t *dst) noexcept
+  {
+    size_t i = 0;
+    for (; i < count && (uint8_t)src[i] < 0x80; ++i)
+      dst[i] = (dst_char_t)src[i];
+    return i;
+  }
+
+  static size_t narrow_ascii_scalar(const char16_t *src, size_t count, char *dst) noexcept
+  {
+    size_t i = 0;
+    for (; i < count && src[i] < 0x80; ++i)
+      dst[i] = (char)src[i];
+    return i;
+  }
+
+  static void count_utf8_scalar(const char *src, size_t count, size_t &continuations, size_t &four_byte_leads) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      uint8_t byte = (uint8_t)src[i];
+      continuations += (byte & 0xC0) == 0x80;
+      four_byte_leads += byte >= 0xF0;
+    }
+  }
+
+  static size_t skip_utf8_scalar(const char *src, size_t count, size_t chars) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (((uint8_t)src[i] & 0xC0) != 0x80 && chars-- == 0)
+        return i;
+    }
+    return count;
+  }
+
+  //index of set bit n counting up from the lowest, mask must have more than n bits set
+  static uint32_t nth_set_bit(uint64_t mask, size_t n) noexcept
+  {
+    for (; n != 0; --n)
+      mask &= mask - 1;
+    return count_trailing_zeros64(mask);
+  }
+
+  static void count_utf16_scalar(const char16_t *src, size_t count, size_t &utf8_extra, size_t &pairs) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      char16_t unit = src[i];
+      utf8_extra += (unit >= 0x80) + (unit >= 0x800);
+      if ((unit & 0xFC00) == 0xD800 && i + 1 < count && (src[i + 1] & 0xFC00) == 0xDC00)
+      {
+        //the high half of a pair is counted as nothing and the low half as the whole four bytes
+        utf8_extra -= 2;
+        ++pairs;
+      }
+    }
+  }
+
+  static void count_utf32_scalar(const char32_t *src, size_t count, size_t &utf8_extra, size_t &utf16_extra) noexcept
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      char32_t code_point = src[i];
+      //anything past 0x10FFFF is written as a three byte replacement character
+      utf8_extra += (code_point >= 0x80) + (code_point >= 0x800) + (code_point >= 0x10000) - (code_point > 0x10FFFF);
+      utf16_extra += code_point >= 0x10000;
+    }
+  }
+
+  //the strict utf8 rules, returns the offset of the lead of the first malformed sequence or count
+  static size_t validate_utf8_scalar(const char *src, size_t count, size_t i) noexcept
+  {
+    while (i < count)
+    {
+      uint8_t lead = (uint8_t)src[i];
+      if (lead < 0x80)
+      {
+        ++i;
+        continue;
+      }
+
+      //the second byte range also rules out overlong forms, surrogates and code points past 0x10FFFF
+      size_t length;
+      uint8_t second_min = 0x80, second_max = 0xBF;
+      if (lead < 0xC2)
+        return i;
+      else if (lead < 0xE0)
+        length = 2;
+      else if (lead < 0xF0)
+      {
+        length = 3;
+        if (lead == 0xE0)
+          second_min = 0xA0;
+        else if (lead == 0xED)
+          second_max = 0x9F;
+      }
+      else if (lead < 0xF5)
+      {
+        length = 4;
+        if (lead == 0xF0)
+          second_min = 0x90;
+        else if (lead == 0xF4)
+          second_max = 0x8F;
+      }
+      else
+        return i;
+
+      if (count - i < length)
+        return i;
+      uint8_t second = (uint8_t)src[i + 1];
+      if (second < second_min || second > second_max)
+        return i;
+      for (size_t k = 2; k < length; ++k)
+      {
+        if (((uint8_t)src[i + k] & 0xC0) != 0x80)
+          return i;
+      }
+      i += length;
+    }
+    return count;
+  }
+
+  //the simd kernels only know an error is in or just before the block at i, everything before the last character that started in the three bytes before it is valid
+  static size_t validate_utf8_resync(const char *src, size_t count, size_t i) noexcept
+  {
+    size_t start = i;
+    for (size_t back = 1; back <= 3 && back <= i; ++back)
+    {
+      if (((uint8_t)src[i - back] & 0xC0) != 0x80)
+      {
+        start = i - back;
+        break;
+      }
+    }
+    return validate_utf8_scalar(src, count, start);
+  }
+
+  //checks the units from i up to end, a pair may run one past it, false leaves i at the unpaired surrogate
+  static bool check_utf16(const char16_t *src, size_t count, size_t &i, size_t end) noexcept
+  {
+    while (i < end)
+    {
+      char16_t unit = src[i];
+      if ((unit & 0xF800) != 0xD800)
+      {
+        ++i;
+        continue;
+      }
+      if (unit >= 0xDC00 || i + 1 >= count || (src[i + 1] & 0xFC00) != 0xDC00)
+        return false;
+      i += 2;
+    }
+    return true;
+  }
+
+  static size_t validate_utf8_from_start(const char *src, size_t count) noexcept
+  {
+    return validate_utf8_scalar(src, count, 0);
+  }
+
+  static size_t validate_utf16_scalar(const char16_t *src, size_t count) noexcept
+  {
+    size_t i = 0;
+    return check_utf16(src, count, i, count) ? count : i;
+  }
+
+#if defined(SMALL_TL_X86)
+  //lane counters are flushed before they can overflow, byte lanes after 255 steps and 16 bit lanes that gain up to 2 a step before they turn negative
+  static const size_t byte_block = 255;
+  static const size_t u16_block = 16383;
+  static const size_t u32_block = size_t(1) << 29;
+
+  //
+  //sse2
+  //
+
+  static size_t sum_bytes_sse2(__m128i counters) noexcept
+  {
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, _mm_sad_epu8(counters, _mm_setzero_si128()));
+    return (size_t)(lanes[0] + lanes[1]);
+  }
+
+  static size_t sum_u32_sse2(__m128i counters) noexcept
+  {
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i *)lanes, counters);
+    return (size_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  //unsigned lanes at or above threshold, sse2 only compares signed so both sides are offset by the sign bit
+  static __m128i at_least_u32_sse2(__m128i values, uint32_t threshold) noexcept
+  {
+    const __m128i sign = _mm_set1_epi32((int)0x80000000);
+    return _mm_cmpgt_epi32(_mm_xor_si128(values, sign), _mm_set1_epi32((int)((threshold - 1) ^ 0x80000000)));
+  }
+
+  //16 bytes per step, a block with any top bit set is finished by the scalar loop up to its first non ascii byte
+  static size_t widen_ascii_u16_sse2(const char *src, size_t count, char16_t *dst) noexcept
+  {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+      if (_mm_movemask_epi8(bytes) != 0)
+        break;
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi8(bytes, zero));
+      _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+    return i + widen_ascii_scalar(src + i, count - i, dst + i);
+  }
+
+  static size_t widen_ascii_u32_sse2(const char *src, size_t count, char32_t *dst) noexcept
+  {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+      if (_mm_movemask_epi8(bytes) != 0)
+        break;
+      __m128i low = _mm_unpacklo_epi8(bytes, zero);
+      __m128i high = _mm_unpackhi_epi8(bytes, zero);
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(low, zero));
+      _mm_storeu_si128((__m128i *)(dst + i + 4), _mm_unpackhi_epi16(low, zero));
+      _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpacklo_epi16(high, zero));
+      _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(high, zero));
+    }
+    return i + widen_ascii_scalar(src + i, count - i, dst + i);
+  }
+
+  //16 units per step, any unit with a bit at or above 0x80 ends the fast loop
+  static size_t narrow_ascii_sse2(const char16_t *src, size_t count, char *dst) noexcept
+  {
+    const __m128i non_ascii = _mm_set1_epi16((short)0xFF80);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i low = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i high = _mm_loadu_si128((const __m128i *)(src + i + 8));
+      __m128i masked = _mm_and_si128(_mm_or_si128(low, high), non_ascii);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(masked, _mm_setzero_si128())) != 0xFFFF)
+        break;
+      _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(low, high));
+    }
+    return i + narrow_ascii_scalar(src + i, count - i, dst + i);
+  }
+
+  static void count_utf8_sse2(const char *src, size_t count, size_t &continuations, size_t &four_byte_leads) noexcept
+  {
+    //continuation bytes are the signed values below -64
+    const __m128i continuation_limit = _mm_set1_epi8(-64);
+    const __m128i four_byte_lead = _mm_set1_epi8((char)0xF0);
+    size_t i = 0;
+    while (i + 16 <= count)
+    {
+      __m128i continuation_counters = _mm_setzero_si128(), lead_counters = _mm_setzero_si128();
+      size_t block_end = std::min(count & ~size_t(15), i + byte_block * 16);
+      for (; i < block_end; i += 16)
+      {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i));
+        continuation_counters = _mm_sub_epi8(continuation_counters, _mm_cmpgt_epi8(continuation_limit, bytes));
+        lead_counters = _mm_sub_epi8(lead_counters, _mm_cmpeq_epi8(_mm_max_epu8(bytes, four_byte_lead), bytes));
+      }
+      continuations += sum_bytes_sse2(continuation_counters);
+      four_byte_leads += sum_bytes_sse2(lead_counters);
+    }
+    count_utf8_scalar(src + i, count - i, continuations, four_byte_leads);
+  }
+
+  //64 bytes a step, a mask of the bytes that start a character is counted until the one wanted is in it
+  static size_t skip_utf8_sse2(const char *src, size_t count, size_t chars) noexcept
+  {
+    const __m128i continuation_limit = _mm_set1_epi8(-65);
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+      uint64_t leads = 0;
+      for (size_t part = 0; part < 4; ++part)
+      {
+        __m128i bytes = _mm_loadu_si128((const __m128i *)(src + i + part * 16));
+        leads |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpgt_epi8(bytes, continuation_limit)) << (part * 16);
+      }
+      size_t found = count_set_bits64(leads);
+      if (chars < found)
+        return i + nth_set_bit(leads, chars);
+      chars -= found;
+    }
+    return i + skip_utf8_scalar(src + i, count - i, chars);
+  }
+
+  //each step also loads the units one along, so a pair is seen from its high half even across steps
+  static void count_utf16_sse2(const char16_t *src, size_t count, size_t &utf8_extra, size_t &pairs) noexcept
+  {
+    const __m128i above_7f = _mm_set1_epi16((short)0xFF80), above_7ff = _mm_set1_epi16((short)0xF800);
+    const __m128i surrogate_mask = _mm_set1_epi16((short)0xFC00), high = _mm_set1_epi16((short)0xD800), low = _mm_set1_epi16((short)0xDC00);
+    const __m128i two = _mm_set1_epi16(2), ones = _mm_set1_epi16(1), zero = _mm_setzero_si128();
+    size_t i = 0;
+    while (i + 9 <= count)
+    {
+      __m128i extra_counters = zero, pair_counters = zero;
+      size_t block_end = std::min(count - 8, i + u16_block * 8);
+      for (; i < block_end; i += 8)
+      {
+        __m128i units = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i next = _mm_loadu_si128((const __m128i *)(src + i + 1));
+        __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(units, above_7f), zero);
+        __m128i two_byte = _mm_cmpeq_epi16(_mm_and_si128(units, above_7ff), zero);
+        __m128i pair = _mm_and_si128(_mm_cmpeq_epi16(_mm_and_si128(units, surrogate_mask), high), _mm_cmpeq_epi16(_mm_and_si128(next, surrogate_mask), low));
+        extra_counters = _mm_add_epi16(extra_counters, _mm_add_epi16(_mm_add_epi16(two, ascii), _mm_add_epi16(two_byte, _mm_add_epi16(pair, pair))));
+        pair_counters = _mm_sub_epi16(pair_counters, pair);
+      }
+      utf8_extra += sum_u32_sse2(_mm_madd_epi16(extra_counters, ones));
+      pairs += sum_u32_sse2(_mm_madd_epi16(pair_counters, ones));
+    }
+    count_utf16_scalar(src + i, count - i, utf8_extra, pairs);
+  }
+
+  static void count_utf32_sse2(const char32_t *src, size_t count, size_t &utf8_extra, size_t &utf16_extra) noexcept
+  {
+    size_t i = 0;
+    while (i + 4 <= count)
+    {
+      __m128i utf8_counters = _mm_setzero_si128(), utf16_counters = _mm_setzero_si128();
+      size_t block_end = std::min(count & ~size_t(3), i + u32_block * 4);
+      for (; i < block_end; i += 4)
+      {
+        __m128i code_points = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i supplementary = at_least_u32_sse2(code_points, 0x10000);
+        utf8_counters = _mm_sub_epi32(utf8_counters, _mm_add_epi32(at_least_u32_sse2(code_points, 0x80), at_least_u32_sse2(code_points, 0x800)));
+        utf8_counters = _mm_add_epi32(_mm_sub_epi32(utf8_counters, supplementary), at_least_u32_sse2(code_points, 0x110000));
+        utf16_counters = _mm_sub_epi32(utf16_counters, supplementary);
+      }
+      utf8_extra += sum_u32_sse2(utf8_counters);
+      utf16_extra += sum_u32_sse2(utf16_counters);
+    }
+    count_utf32_scalar(src + i, count - i, utf8_extra, utf16_extra);
+  }
+
+  //blocks without surrogates are skipped whole, the rest are checked a unit at a time
+  static size_t validate_utf16_sse2(const char16_t *src, size_t count) noexcept
+  {
+    const __m128i surrogate_mask = _mm_set1_epi16((short)0xF800), surrogate = _mm_set1_epi16((short)0xD800);
+    size_t i = 0;
+    while (i + 8 <= count)
+    {
+      __m128i units = _mm_loadu_si128((const __m128i *)(src + i));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, surrogate_mask), surrogate)) == 0)
+        i += 8;
+      else if (!check_utf16(src, count, i, i + 8))
+        return i;
+    }
+    return check_utf16(src, count, i, count) ? count : i;
+  }
+
+  //
+  //ssse3
+  //
+
+  //the lookup validation of keiser and lemire, each byte is classified by the high nibble of the byte before it, its low nibble, and its own high nibble
+  //a bit survives the three lookups only for a malformed pair, the bits name the error
+  static const uint8_t too_short = 1 << 0;        //a lead or ascii where a continuation was needed
+  static const uint8_t too_long = 1 << 1;         //a continuation after ascii
+  static const uint8_t overlong_3 = 1 << 2;
+  static const uint8_t too_large = 1 << 3;
+  static const uint8_t surrogate = 1 << 4;
+  static const uint8_t overlong_2 = 1 << 5;
+  static const uint8_t too_large_1000 = 1 << 6;
+  static const uint8_t overlong_4 = 1 << 6;
+  static const uint8_t two_continuations = 1 << 7; //fine only where a three or four byte sequence expects it
+  static const uint8_t carry = too_short | too_long | two_continuations;
+
+  static const uint8_t byte_1_high_table[16] =
+  {
+    too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+    two_continuations, two_continuations, two_continuations, two_continuations,
+    too_short | overlong_2,
+    too_short,
+    too_short | overlong_3 | surrogate,
+    too_short | too_large | too_large_1000 | overlong_4
+  };
+
+  static const uint8_t byte_1_low_table[16] =
+  {
+    carry | overlong_3 | overlong_2 | overlong_4,
+    carry | overlong_2,
+    carry,
+    carry,
+    carry | too_large,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000 | surrogate,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000
+  };
+
+  static const uint8_t byte_2_high_table[16] =
+  {
+    too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+    too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+    too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+    too_long | overlong_2 | two_continuations | surrogate | too_large,
+    too_long | overlong_2 | two_continuations | surrogate | too_large,
+    too_short, too_short, too_short, too_short
+  };
+
+  //a lead in the last three bytes that its block cannot finish, the next block must start with continuations
+  static const uint8_t incomplete_limit[32] =
+  {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1
+  };
+
+  SMALL_TL_TARGET_SSSE3 static __m128i utf8_errors_ssse3(__m128i input, __m128i previous) noexcept
+  {
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+    __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+
+    __m128i byte_1_high = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_1_high_table), _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble));
+    __m128i byte_1_low = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_1_low_table), _mm_and_si128(prev1, low_nibble));
+    __m128i byte_2_high = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)byte_2_high_table), _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble));
+    __m128i special_cases = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    //the third and fourth bytes of a sequence are the only places two continuations in a row belong
+    __m128i third_byte = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+    __m128i fourth_byte = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+    __m128i must_continue = _mm_and_si128(_mm_or_si128(third_byte, fourth_byte), _mm_set1_epi8((char)0x80));
+    return _mm_xor_si128(must_continue, special_cases);
+  }
+
+  SMALL_TL_TARGET_SSSE3 static size_t validate_utf8_ssse3(const char *src, size_t count) noexcept
+  {
+    const __m128i limit = _mm_loadu_si128((const __m128i *)(incomplete_limit + 16));
+    __m128i previous = _mm_setzero_si128(), previous_incomplete = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+      __m128i input = _mm_loadu_si128((const __m128i *)(src + i));
+      __m128i errors = previous_incomplete;
+      if (_mm_movemask_epi8(input) != 0)
+        errors = utf8_errors_ssse3(input, previous);
+      if (_mm_movemask_epi8(_mm_cmpeq_epi8(errors, _mm_setzero_si128())) != 0xFFFF)
+        return validate_utf8_resync(src, count, i);
+      previous = input;
+      previous_incomplete = _mm_subs_epu8(input, limit);
+    }
+    return validate_utf8_resync(src, count, i);
+  }
+
+  //
+  //avx2
+  //
+
+  SMALL_TL_TARGET_AVX2 static size_t sum_bytes_avx2(__m256i counters) noexcept
+  {
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, _mm256_sad_epu8(counters, _mm256_setzero_si256()));
+    return (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t sum_u32_avx2(__m256i counters) noexcept
+  {
+    return sum_u32_sse2(_mm_add_epi32(_mm256_castsi256_si128(counters), _mm256_extracti128_si256(counters, 1)));
+  }
+
+  SMALL_TL_TARGET_AVX2 static __m256i at_least_u32_avx2(__m256i values, uint32_t threshold) noexcept
+  {
+    return _mm256_cmpeq_epi32(_mm256_max_epu32(values, _mm256_set1_epi32((int)threshold)), values);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t widen_ascii_u16_avx2(const char *src, size_t count, char16_t *dst) noexcept
+  {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256i bytes = _mm256_loadu_si256((const __m256i *)(src + i));
+      if (_mm256_movemask_epi8(bytes) != 0)
+        break;
+      _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes)));
+      _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1)));
+    }
+    //the sse2 kernels are not vex encoded, leaving the upper halves dirty makes every sse instruction in them pay a transition penalty
+    _mm256_zeroupper();
+    return i + widen_ascii_u16_sse2(src + i, count - i, dst + i);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t widen_ascii_u32_avx2(const char *src, size_t count, char32_t *dst) noexcept
+  {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256i bytes = _mm256_loadu_si256((const __m256i *)(src + i));
+      if (_mm256_movemask_epi8(bytes) != 0)
+        break;
+      __m128i low = _mm256_castsi256_si128(bytes);
+      __m128i high = _mm256_extracti128_si256(bytes, 1);
+      _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi32(low));
+      _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+      _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_cvtepu8_epi32(high));
+      _mm256_storeu_si256((__m256i *)(dst + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+    }
+    _mm256_zeroupper();
+    return i + widen_ascii_u32_sse2(src + i, count - i, dst + i);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t narrow_ascii_avx2(const char16_t *src, size_t count, char *dst) noexcept
+  {
+    const __m256i non_ascii = _mm256_set1_epi16((short)0xFF80);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256i low = _mm256_loadu_si256((const __m256i *)(src + i));
+      __m256i high = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+      if (!_mm256_testz_si256(_mm256_or_si256(low, high), non_ascii))
+        break;
+      //packus interleaves the 128 bit lanes, the permute puts them back in order
+      __m256i packed = _mm256_packus_epi16(low, high);
+      _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    _mm256_zeroupper();
+    return i + narrow_ascii_sse2(src + i, count - i, dst + i);
+  }
+
+  SMALL_TL_TARGET_AVX2 static void count_utf8_avx2(const char *src, size_t count, size_t &continuations, size_t &four_byte_leads) noexcept
+  {
+    const __m256i continuation_limit = _mm256_set1_epi8(-64);
+    const __m256i four_byte_lead = _mm256_set1_epi8((char)0xF0);
+    size_t i = 0;
+    while (i + 32 <= count)
+    {
+      __m256i continuation_counters = _mm256_setzero_si256(), lead_counters = _mm256_setzero_si256();
+      size_t block_end = std::min(count & ~size_t(31), i + byte_block * 32);
+      for (; i < block_end; i += 32)
+      {
+        __m256i bytes = _mm256_loadu_si256((const __m256i *)(src + i));
+        continuation_counters = _mm256_sub_epi8(continuation_counters, _mm256_cmpgt_epi8(continuation_limit, bytes));
+        lead_counters = _mm256_sub_epi8(lead_counters, _mm256_cmpeq_epi8(_mm256_max_epu8(bytes, four_byte_lead), bytes));
+      }
+      continuations += sum_bytes_avx2(continuation_counters);
+      four_byte_leads += sum_bytes_avx2(lead_counters);
+    }
+    _mm256_zeroupper();
+    count_utf8_sse2(src + i, count - i, continuations, four_byte_leads);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t skip_utf8_avx2(const char *src, size_t count, size_t chars) noexcept
+  {
+    const __m256i continuation_limit = _mm256_set1_epi8(-65);
+    size_t i = 0;
+    for (; i + 64 <= count; i += 64)
+    {
+      __m256i low = _mm256_loadu_si256((const __m256i *)(src + i));
+      __m256i high = _mm256_loadu_si256((const __m256i *)(src + i + 32));
+      uint64_t leads = (uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(low, continuation_limit)) | (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(high, continuation_limit)) << 32;
+      size_t found = count_set_bits64(leads);
+      if (chars < found)
+      {
+        _mm256_zeroupper();
+        return i + nth_set_bit(leads, chars);
+      }
+      chars -= found;
+    }
+    _mm256_zeroupper();
+    return i + skip_utf8_scalar(src + i, count - i, chars);
+  }
+
+  SMALL_TL_TARGET_AVX2 static void count_utf16_avx2(const char16_t *src, size_t count, size_t &utf8_extra, size_t &pairs) noexcept
+  {
+    const __m256i above_7f = _mm256_set1_epi16((short)0xFF80), above_7ff = _mm256_set1_epi16((short)0xF800);
+    const __m256i surrogate_mask = _mm256_set1_epi16((short)0xFC00), high = _mm256_set1_epi16((short)0xD800), low = _mm256_set1_epi16((short)0xDC00);
+    const __m256i two = _mm256_set1_epi16(2), ones = _mm256_set1_epi16(1), zero = _mm256_setzero_si256();
+    size_t i = 0;
+    while (i + 17 <= count)
+    {
+      __m256i extra_counters = zero, pair_counters = zero;
+      size_t block_end = std::min(count - 16, i + u16_block * 16);
+      for (; i < block_end; i += 16)
+      {
+        __m256i units = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i next = _mm256_loadu_si256((const __m256i *)(src + i + 1));
+        __m256i ascii = _mm256_cmpeq_epi16(_mm256_and_si256(units, above_7f), zero);
+        __m256i two_byte = _mm256_cmpeq_epi16(_mm256_and_si256(units, above_7ff), zero);
+        __m256i pair = _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_and_si256(units, surrogate_mask), high), _mm256_cmpeq_epi16(_mm256_and_si256(next, surrogate_mask), low));
+        extra_counters = _mm256_add_epi16(extra_counters, _mm256_add_epi16(_mm256_add_epi16(two, ascii), _mm256_add_epi16(two_byte, _mm256_add_epi16(pair, pair))));
+        pair_counters = _mm256_sub_epi16(pair_counters, pair);
+      }
+      utf8_extra += sum_u32_avx2(_mm256_madd_epi16(extra_counters, ones));
+      pairs += sum_u32_avx2(_mm256_madd_epi16(pair_counters, ones));
+    }
+    _mm256_zeroupper();
+    count_utf16_sse2(src + i, count - i, utf8_extra, pairs);
+  }
+
+  SMALL_TL_TARGET_AVX2 static void count_utf32_avx2(const char32_t *src, size_t count, size_t &utf8_extra, size_t &utf16_extra) noexcept
+  {
+    size_t i = 0;
+    while (i + 8 <= count)
+    {
+      __m256i utf8_counters = _mm256_setzero_si256(), utf16_counters = _mm256_setzero_si256();
+      size_t block_end = std::min(count & ~size_t(7), i + u32_block * 8);
+      for (; i < block_end; i += 8)
+      {
+        __m256i code_points = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i supplementary = at_least_u32_avx2(code_points, 0x10000);
+        utf8_counters = _mm256_sub_epi32(utf8_counters, _mm256_add_epi32(at_least_u32_avx2(code_points, 0x80), at_least_u32_avx2(code_points, 0x800)));
+        utf8_counters = _mm256_add_epi32(_mm256_sub_epi32(utf8_counters, supplementary), at_least_u32_avx2(code_points, 0x110000));
+        utf16_counters = _mm256_sub_epi32(utf16_counters, supplementary);
+      }
+      utf8_extra += sum_u32_avx2(utf8_counters);
+      utf16_extra += sum_u32_avx2(utf16_counters);
+    }
+    _mm256_zeroupper();
+    count_utf32_sse2(src + i, count - i, utf8_extra, utf16_extra);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t validate_utf16_avx2(const char16_t *src, size_t count) noexcept
+  {
+    const __m256i surrogate_mask = _mm256_set1_epi16((short)0xF800), surrogate = _mm256_set1_epi16((short)0xD800);
+    size_t i = 0;
+    while (i + 16 <= count)
+    {
+      __m256i units = _mm256_loadu_si256((const __m256i *)(src + i));
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(units, surrogate_mask), surrogate)) == 0)
+        i += 16;
+      else if (!check_utf16(src, count, i, i + 16))
+        return i;
+    }
+    return check_utf16(src, count, i, count) ? count : i;
+  }
+
+  //the tables repeat in both 128 bit lanes since vpshufb looks up within a lane
+  SMALL_TL_TARGET_AVX2 static __m256i broadcast_table_avx2(const uint8_t *table) noexcept
+  {
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+  }
+
+  SMALL_TL_TARGET_AVX2 static __m256i utf8_errors_avx2(__m256i input, __m256i previous) noexcept
+  {
+    const __m256i low_nibble = _mm256_set1_epi8(0x0F);
+    //the high lane of previous with the low lane of input, so alignr can shift across the lane boundary
+    __m256i straddle = _mm256_permute2x128_si256(previous, input, 0x21);
+    __m256i prev1 = _mm256_alignr_epi8(input, straddle, 15);
+    __m256i prev2 = _mm256_alignr_epi8(input, straddle, 14);
+    __m256i prev3 = _mm256_alignr_epi8(input, straddle, 13);
+
+    __m256i byte_1_high = _mm256_shuffle_epi8(broadcast_table_avx2(byte_1_high_table), _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_nibble));
+    __m256i byte_1_low = _mm256_shuffle_epi8(broadcast_table_avx2(byte_1_low_table), _mm256_and_si256(prev1, low_nibble));
+    __m256i byte_2_high = _mm256_shuffle_epi8(broadcast_table_avx2(byte_2_high_table), _mm256_and_si256(_mm256_srli_epi16(input, 4), low_nibble));
+    __m256i special_cases = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    __m256i third_byte = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth_byte = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third_byte, fourth_byte), _mm256_set1_epi8((char)0x80));
+    return _mm256_xor_si256(must_continue, special_cases);
+  }
+
+  SMALL_TL_TARGET_AVX2 static size_t validate_utf8_avx2(const char *src, size_t count) noexcept
+  {
+    const __m256i limit = _mm256_loadu_si256((const __m256i *)incomplete_limit);
+    __m256i previous = _mm256_setzero_si256(), previous_incomplete = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+      __m256i input = _mm256_loadu_si256((const __m256i *)(src + i));
+      __m256i errors = previous_incomplete;
+      if (_mm256_movemask_epi8(input) != 0)
+        errors = utf8_errors_avx2(input, previous);
+      if (!_mm256_testz_si256(errors, errors))
+        return validate_utf8_resync(src, count, i);
+      previous = input;
+      previous_incomplete = _mm256_subs_epu8(input, limit);
+    }
+    return validate_utf8_resync(src, count, i);
+  }
+#endif
+
+  //
+  //dispatch
+  //
+
+  struct kernels
+  {
+    size_t (*widen_ascii_u16)(const char *, size_t, char16_t *) noexcept;
+    size_t (*widen_ascii_u32)(const char *, size_t, char32_t *) noexcept;
+    size_t (*narrow_ascii_u16)(const char16_t *, size_t, char *) noexcept;
+    void (*count_utf8)(const char *, size_t, size_t &, size_t &) noexcept;
+    size_t (*skip_utf8)(const char *, size_t, size_t) noexcept;
+    void (*count_utf16)(const char16_t *, size_t, size_t &, size_t &) noexcept;
+    void (*count_utf32)(const char32_t *, size_t, size_t &, size_t &) noexcept;
+    size_t (*validate_utf8)(const char *, size_t) noexcept;
+    size_t (*validate_utf16)(const char16_t *, size_t) noexcept;
+  };
+
+  static kernels select_kernels()
+  {
+    kernels selected = { &widen_ascii_scalar<char16_t>, &widen_ascii_scalar<char32_t>, &narrow_ascii_scalar, &count_utf8_scalar, &skip_utf8_scalar, &count_utf16_scalar, &count_utf32_scalar, &validate_utf8_from_start, &validate_utf16_scalar };
+#if defined(SMALL_TL_X86)
+    const cpu_features &features = get_cpu_features();
+    if (features.avx2)
+      selected = { &widen_ascii_u16_avx2, &widen_ascii_u32_avx2, &narrow_ascii_avx2, &count_utf8_avx2, &skip_utf8_avx2, &count_utf16_avx2, &count_utf32_avx2, &validate_utf8_avx2, &validate_utf16_avx2 };
+    else if (features.sse2)
+      selected = { &widen_ascii_u16_sse2, &widen_ascii_u32_sse2, &narrow_ascii_sse2, &count_utf8_sse2, &skip_utf8_sse2, &count_utf16_sse2, &count_utf32_sse2, features.ssse3 ? &validate_utf8_ssse3 : &validate_utf8_from_start, &validate_utf16_sse2 };
+#endif
+    return selected;
+  }
+
+  static const kernels &get_kernels()
+  {
+    static const kernels selected = select_kernels();
+    return selected;
+  }
+
+  //
+  //entry points
+  //
+
+  size_t widen_ascii(const char *src, size_t count, char16_t *dst) noexcept { return get_kernels().widen_ascii_u16(src, count, dst); }
+  size_t widen_ascii(const char *src, size_t count, char32_t *dst) noexcept { return get_kernels().widen_ascii_u32(src, count, dst); }
+  size_t narrow_ascii(const char16_t *src, size_t count, char *dst) noexcept { return get_kernels().narrow_ascii_u16(src, count, dst); }
+
+  void count_utf8(const char *src, size_t count, size_t &continuations, size_t &four_byte_leads) noexcept
+  {
+    continuations = four_byte_leads = 0;
+    get_kernels().count_utf8(src, count, continuations, four_byte_leads);
+  }
+
+  size_t skip_utf8(const char *src, size_t count, size_t chars) noexcept { return get_kernels().skip_utf8(src, count, chars); }
+
+  void count_utf16(const char16_t *src, size_t count, size_t &utf8_extra, size_t &pairs) noexcept
+  {
+    utf8_extra = pairs = 0;
+    get_kernels().count_utf16(src, count, utf8_extra, pairs);
+  }
+
+  void count_utf32(const char32_t *src, size_t count, size_t &utf8_extra, size_t &utf16_extra) noexcept
+  {
+    utf8_extra = utf16_extra = 0;
+    get_kernels().count_utf32(src, count, utf8_extra, utf16_extra);
+  }
+
+  size_t validate_utf8(const char *src, size_t count) noexcept { return get_kernels().validate_utf8(src, count); }
+  size_t validate_utf16(const char16_t *src, size_t count) noexcept { return get_kernels().validate_utf16(src, count); }
+}
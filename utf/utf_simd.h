@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace small_tl::utf_convert::simd
+{
+  //widens the leading ascii bytes of src into dst and returns how many there were, stopping at the first byte with its top bit set
+  //dst must have room for count characters, kernels are picked at runtime from sse2 or avx2
+  size_t widen_ascii(const char *src, size_t count, char16_t *dst) noexcept;
+  size_t widen_ascii(const char *src, size_t count, char32_t *dst) noexcept;
+
+  //the reverse for utf16, copies the leading units below 0x80 into dst as bytes and returns how many there were
+  size_t narrow_ascii(const char16_t *src, size_t count, char *dst) noexcept;
+
+  //the tallies the length functions in utf_convert are built from
+  //utf8 bytes that continue a sequence and bytes that lead a four byte one
+  void count_utf8(const char *src, size_t count, size_t &continuations, size_t &four_byte_leads) noexcept;
+
+  //utf8 bytes needed beyond one per unit, with a surrogate pair needing four in all, and the number of surrogate pairs
+  void count_utf16(const char16_t *src, size_t count, size_t &utf8_extra, size_t &pairs) noexcept;
+
+  //utf8 bytes and utf16 units needed beyond one per code point
+  void count_utf32(const char32_t *src, size_t count, size_t &utf8_extra, size_t &utf16_extra) noexcept;
+
+  //offset of the character chars characters into src, or count when src holds no more
+  //a character starts at every byte that is not a continuation byte, so this is exact for well formed utf8
+  size_t skip_utf8(const char *src, size_t count, size_t chars) noexcept;
+
+  //offset of the first malformed sequence or unpaired surrogate, count when src is valid, see validate_utf8 in utf_convert
+  size_t validate_utf8(const char *src, size_t count) noexcept;
+  size_t validate_utf16(const char16_t *src, size_t count) noexcept;
+}
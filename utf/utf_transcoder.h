@@ -0,0 +1,223 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "utf_convert.h"
+#include "../pod_span.h"
+
+namespace small_tl::utf_convert
+{
+  //how much of the source was consumed and how much of the destination was filled
+  struct transcode_result
+  {
+    size_t read;
+    size_t written;
+  };
+
+  //converts a stream of utf8, utf16 or utf32 arriving in chunks of any size into caller owned buffers
+  //a sequence or surrogate pair cut off by the end of a chunk is held back and finished by the next one, so the output is the same as converting the whole stream at once
+  template<class from_t, class to_t>
+  class utf_transcoder
+  {
+    static_assert(std::is_integral<from_t>::value && (sizeof(from_t) == 1 || sizeof(from_t) == 2 || sizeof(from_t) == 4), "from_t must be an 8, 16 or 32 bit integral type");
+    static_assert(std::is_integral<to_t>::value && (sizeof(to_t) == 1 || sizeof(to_t) == 2 || sizeof(to_t) == 4), "to_t must be an 8, 16 or 32 bit integral type");
+
+    //the longest sequence of from_t and to_t that make up one code point
+    static constexpr size_t max_sequence = 4 / sizeof(from_t);
+    static constexpr size_t max_units = 4 / sizeof(to_t);
+
+  public:
+    typedef transcode_result result;
+
+    utf_transcoder() noexcept : m_pending_count(0) {}
+
+    //converts src into dst until one of them runs out, read only stops short of count when dst is full, resubmit the rest with more room
+    //a dst with room for less than a whole character makes no progress
+    result transcode(const from_t *src, size_t count, to_t *dst, size_t capacity) noexcept
+    {
+      result done = { 0, 0 };
+      if (m_pending_count != 0)
+      {
+        //the held back units plus enough of src to finish any character that starts in them
+        from_t window[max_sequence * 2];
+        size_t taken = std::min(count, max_sequence);
+        memcpy(window, m_pending, m_pending_count * sizeof(from_t));
+        if (taken != 0)
+          memcpy(window + m_pending_count, src, taken * sizeof(from_t));
+
+        result flushed = convert_chars(window, m_pending_count, m_pending_count + taken, dst, capacity, true);
+        done.written = flushed.written;
+        if (flushed.read < m_pending_count)
+        {
+          if (hold_truncated(window + flushed.read, m_pending_count + taken - flushed.read))
+            return { taken, done.written };
+
+          //out of room, the rest of the held back units wait for the next call
+          m_pending_count -= (uint8_t)flushed.read;
+          memmove(m_pending, m_pending + flushed.read, m_pending_count * sizeof(from_t));
+          return done;
+        }
+        done.read = flushed.read - m_pending_count;
+        m_pending_count = 0;
+      }
+
+      bulk_convert(src, count, dst, capacity, done);
+
+      result converted = convert_chars(src + done.read, count - done.read, count - done.read, dst + done.written, capacity - done.written, true);
+      done.read += converted.read;
+      done.written += converted.written;
+      if (done.read != count && hold_truncated(src + done.read, count - done.read))
+        done.read = count;
+      return done;
+    }
+
+    //writes out a held back sequence the same way the one shot converters treat a truncated one, call once the stream has ended
+    //returns the units written, pending() stays true if dst ran out of room first
+    size_t finish(to_t *dst, size_t capacity) noexcept
+    {
+      result flushed = convert_chars(m_pending, m_pending_count, m_pending_count, dst, capacity, false);
+      m_pending_count -= (uint8_t)flushed.read;
+      memmove(m_pending, m_pending + flushed.read, m_pending_count * sizeof(from_t));
+      return flushed.written;
+    }
+
+    //the units of a partial character held back, zero once everything is written
+    size_t pending() const noexcept { return m_pending_count; }
+
+    //drops anything held back, ready for a new stream
+    void reset() noexcept { m_pending_count = 0; }
+
+  private:
+    //true if src ends partway through a sequence that would otherwise be well formed
+    static bool is_truncated(const from_t *src, size_t available) noexcept
+    {
+      if constexpr (sizeof(from_t) == 1)
+      {
+        if ((uint8_t)src[0] < 0xC0 || available >= bytes_in_utf8_sequence((char)src[0]))
+          return false;
+        for (size_t i = 1; i < available; ++i)
+        {
+          if ((src[i] & 0xC0) != 0x80)
+            return false;
+        }
+        return true;
+      }
+      else if constexpr (sizeof(from_t) == 2)
+        return available == 1 && utf16_order_of_char((char16_t)src[0]) == HIGH_SURROGATE;
+      else
+        return false;
+    }
+
+    //keeps a truncated tail for the next call
+    bool hold_truncated(const from_t *src, size_t available) noexcept
+    {
+      if (!is_truncated(src, available))
+        return false;
+      memcpy(m_pending, src, available * sizeof(from_t));
+      m_pending_count = (uint8_t)available;
+      return true;
+    }
+
+    static size_t decode(const from_t *src, size_t available, char32_t &code_point) noexcept
+    {
+      if constexpr (sizeof(from_t) == 4)
+      {
+        code_point = (char32_t)src[0];
+        return 1;
+      }
+      else
+      {
+        int8_t chars_read = to_utf32_char(src, (uint8_t)std::min(available, max_sequence), code_point);
+        return chars_read >= 1 ? chars_read : 1;
+      }
+    }
+
+    static size_t encode(char32_t code_point, to_t *dst) noexcept
+    {
+      if constexpr (sizeof(to_t) == 1)
+        return to_utf8_char(code_point, (char *)dst);
+      else if constexpr (sizeof(to_t) == 2)
+        return to_utf16_char(code_point, (char16_t *)dst);
+      else
+      {
+        dst[0] = (to_t)code_point;
+        return 1;
+      }
+    }
+
+    //one character at a time for the characters that start before limit, count is how much of src may be looked at
+    static result convert_chars(const from_t *src, size_t limit, size_t count, to_t *dst, size_t capacity, bool stop_at_truncated) noexcept
+    {
+      result done = { 0, 0 };
+      while (done.read < limit)
+      {
+        if (stop_at_truncated && is_truncated(src + done.read, count - done.read))
+          break;
+
+        char32_t code_point;
+        size_t read = decode(src + done.read, count - done.read, code_point);
+        to_t units[max_units];
+        size_t written = encode(code_point, units);
+        if (written > capacity - done.written)
+          break;
+
+        memcpy(dst + done.written, units, written * sizeof(to_t));
+        done.read += read;
+        done.written += written;
+      }
+      return done;
+    }
+
+    //hands the part of src that is sure to fit in dst and ends on a whole character to the raw buffer converters
+    static void bulk_convert(const from_t *src, size_t count, to_t *dst, size_t capacity, result &done) noexcept
+    {
+      if constexpr (sizeof(from_t) == 1 && sizeof(to_t) > 1)
+      {
+        //every byte of utf8 makes at most one unit of utf16 or utf32
+        const char *src_chars = (const char *)src + done.read;
+        size_t bulk = std::min(count - done.read, capacity - done.written);
+
+        //back off a lead byte whose sequence would run past the end
+        size_t lead = bulk;
+        while (lead > 0 && bulk - lead < 3 && ((uint8_t)src_chars[lead - 1] & 0xC0) == 0x80)
+          --lead;
+        if (lead > 0 && (uint8_t)src_chars[lead - 1] >= 0xC0 && bytes_in_utf8_sequence(src_chars[lead - 1]) > bulk - (lead - 1))
+          bulk = lead - 1;
+
+        if constexpr (sizeof(to_t) == 2)
+          done.written += utf8_to_utf16(src_chars, bulk, (char16_t *)dst + done.written);
+        else
+          done.written += utf8_to_utf32(src_chars, bulk, (char32_t *)dst + done.written);
+        done.read += bulk;
+      }
+      else if constexpr (sizeof(from_t) == 2 && sizeof(to_t) == 1)
+      {
+        //every unit of utf16 makes at most three bytes of utf8
+        const char16_t *src_chars = (const char16_t *)src + done.read;
+        size_t bulk = std::min(count - done.read, (capacity - done.written) / 3);
+        if (bulk > 0 && utf16_order_of_char(src_chars[bulk - 1]) == HIGH_SURROGATE)
+          --bulk;
+
+        done.written += utf16_to_utf8(src_chars, bulk, (char *)dst + done.written);
+        done.read += bulk;
+      }
+    }
+
+    from_t m_pending[max_sequence];
+    uint8_t m_pending_count;
+  };
+
+  //converts src into caller owned dst without allocating, stopping at the last whole character that fits
+  //a sequence truncated by the end of src is converted the way the one shot converters do, use utf_transcoder when more input follows
+  //size dst with the utf*_length_from_* functions to convert everything in one call
+  template<class src_t, class dst_t>
+  transcode_result convert_into(pod_span<src_t> src, pod_span<dst_t> dst) noexcept
+  {
+    utf_transcoder<typename std::remove_const<src_t>::type, dst_t> transcoder;
+    transcode_result done = transcoder.transcode(src.data(), src.size(), dst.data(), dst.size());
+    done.written += transcoder.finish(dst.data() + done.written, dst.size() - done.written);
+    done.read -= transcoder.pending();
+    return done;
+  }
+}